@@ -25,6 +25,8 @@
 #include "sounds/SoundHandler.hpp"
 #include "system/exception_handler.h"
 #include "system/memory.h"
+#include "system/TimerService.h"
+#include "install/TitleIndex.h"
 #include "utils/logger.h"
 #include "video/CursorDrawer.h"
 
@@ -67,6 +69,8 @@ Application::~Application()
 		delete controller[i];
 	
 	AsyncDeleter::destroyInstance();
+	TimerService::destroyInstance();
+	TitleIndex::destroyInstance();
 	GuiImageAsync::threadExit();
 	Resources::Clear();
 	
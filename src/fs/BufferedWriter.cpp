@@ -0,0 +1,61 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include "BufferedWriter.h"
+
+BufferedWriter::BufferedWriter(const std::string & filePath, u32 size)
+	: CThread(CThread::eAttributeAffCore1, 20)
+	, path(filePath)
+	, flushSize(size)
+	, exitRequested(false)
+{
+	resumeThread();
+}
+
+BufferedWriter::~BufferedWriter()
+{
+	exitRequested = true;
+	writeEvent.signal();
+	shutdownThread();
+}
+
+void BufferedWriter::write(const std::string & data)
+{
+	writeMutex.lock();
+	pending += data;
+	bool full = (pending.size() >= flushSize);
+	writeMutex.unlock();
+
+	if(full)
+		writeEvent.signal();
+}
+
+void BufferedWriter::writePending(void)
+{
+	std::string data;
+
+	writeMutex.lock();
+	data.swap(pending);
+	writeMutex.unlock();
+
+	if(data.empty())
+		return;
+
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0666);
+	if(fd < 0)
+		return;
+
+	::write(fd, data.c_str(), data.size());
+	::close(fd);
+}
+
+void BufferedWriter::executeThread(void)
+{
+	while(!exitRequested)
+	{
+		writeEvent.wait();
+		writePending();
+	}
+
+	//! whatever came in while shutting down
+	writePending();
+}
@@ -0,0 +1,35 @@
+#ifndef _BUFFERED_WRITER_H_
+#define _BUFFERED_WRITER_H_
+
+#include <string>
+#include "system/CThread.h"
+#include "system/CMutex.h"
+#include "system/CEvent.h"
+
+//! Appends to a file from its own thread so the caller never waits for
+//! the sd card. Data is written once flushSize bytes are pending, on
+//! flush() and when the writer is destroyed.
+class BufferedWriter : public CThread
+{
+public:
+	BufferedWriter(const std::string & path, u32 flushSize = 0x4000);
+	virtual ~BufferedWriter();
+
+	void write(const std::string & data);
+	//! Writes whatever is pending without waiting for it
+	void flush() { writeEvent.signal(); }
+
+private:
+	void executeThread(void);
+	void writePending(void);
+
+	std::string path;
+	u32 flushSize;
+	std::string pending;
+
+	volatile bool exitRequested;
+	CMutex writeMutex;
+	CEvent writeEvent;
+};
+
+#endif // _BUFFERED_WRITER_H_
@@ -28,35 +28,62 @@
 #include "CFolderList.hpp"
 #include "DirList.h"
 #include "CFile.hpp"
+#include <algorithm>
+#include <stdio.h>
 #include <coreinit/internal.h>
 
-void CFolderList::AddFolder()
+CFolderList::FolderStruct * CFolderList::NewFolder()
 {
 	FolderStruct * newFolder = new FolderStruct;
 	newFolder->name = "";
 	newFolder->path = "";
 	newFolder->selected = false;
-	newFolder->sequence = 0;
+	newFolder->index = -1;
+	newFolder->prevSelected = NULL;
+	newFolder->nextSelected = NULL;
+	newFolder->titleId = 0;
+	newFolder->size = 0;
+	newFolder->sizeKnown = false;
 	
-	Folders.push_back(newFolder);
+	return newFolder;
 }
 
-std::string CFolderList::GetName(int ind)
+void CFolderList::AddFolder()
 {
+	Folders.push_back(NewFolder());
+	Folders.back()->index = Folders.size() - 1;
+}
+
+const std::string & CFolderList::GetName(int ind)
+{
+	static const std::string emptyString;
+	
 	if(ind < 0 || ind >= (int) Folders.size())
-		return "";
+		return emptyString;
 
 	return Folders.at(ind)->name;
 }
 
-std::string CFolderList::GetPath(int ind)
+const std::string & CFolderList::GetPath(int ind)
 {
+	static const std::string emptyString;
+	
 	if(ind < 0 || ind >= (int) Folders.size())
-		return "";
+		return emptyString;
 
 	return Folders.at(ind)->path;
 }
 
+const TitleManifest & CFolderList::GetManifest(int ind)
+{
+	static const TitleManifest emptyManifest;
+	
+	if(ind < 0 || ind >= (int) Folders.size())
+		return emptyManifest;
+
+	return Folders.at(ind)->manifest;
+}
+
 bool CFolderList::IsSelected(int ind)
 {
 	if(ind < 0 || ind >= (int) Folders.size())
@@ -70,8 +97,18 @@ void CFolderList::Select(int ind)
 	if(ind < 0 || ind >= (int) Folders.size())
 		return;
 
-	Folders.at(ind)->selected = true;
-	AddSequence(ind);
+	//! only one folder of a title can be installed
+	if(IsDuplicate(ind))
+	{
+		const std::vector<int> & folders = TitleFolders[Folders.at(ind)->titleId];
+		for(u32 i = 0; i < folders.size(); i++)
+		{
+			if(folders[i] != ind && IsSelected(folders[i]))
+				UnSelect(folders[i]);
+		}
+	}
+
+	LinkSelected(Folders.at(ind));
 }
 
 void CFolderList::UnSelect(int ind)
@@ -79,8 +116,7 @@ void CFolderList::UnSelect(int ind)
 	if(ind < 0 || ind >= (int) Folders.size())
 		return;
 
-	Folders.at(ind)->selected = false;
-	RemoveSequence(ind);
+	UnlinkSelected(Folders.at(ind));
 }
 
 void CFolderList::SelectAll()
@@ -90,59 +126,160 @@ void CFolderList::SelectAll()
 	
 	for(u32 i = 0; i < Folders.size(); i++)
 	{
-		Folders.at(i)->selected = true;
-		AddSequence(i);
+		//! of a title in several folders only the newest one
+		if(Folders.at(i)->selected || GetNewest(i) != (int) i)
+			continue;
+		
+		Select(i);
 	}
 }
 
 void CFolderList::UnSelectAll()
 {
-	if(!Folders.size())
-		return;
-	
-	for(u32 i = 0; i < Folders.size(); i++)
-	{
-		Folders.at(i)->selected = false;
-		Folders.at(i)->sequence = 0;
-	}
+	while(firstSelected)
+		UnlinkSelected(firstSelected);
 }
 
 int CFolderList::GetFirstSelected()
 {
-	if(!Folders.size())
+	if(!firstSelected)
 		return -1;
 	
-	int found = -1;
-	for(u32 i = 0; i < Folders.size() && found < 0; i++)
+	return firstSelected->index;
+}
+
+u64 CFolderList::GetTitleId(int ind)
+{
+	if(ind < 0 || ind >= (int) Folders.size())
+		return 0;
+
+	return Folders.at(ind)->titleId;
+}
+
+u64 CFolderList::GetSize(int ind)
+{
+	if(ind < 0 || ind >= (int) Folders.size())
+		return 0;
+
+	return Folders.at(ind)->size;
+}
+
+bool CFolderList::IsSizeKnown(int ind)
+{
+	if(ind < 0 || ind >= (int) Folders.size())
+		return false;
+
+	return Folders.at(ind)->sizeKnown;
+}
+
+bool CFolderList::IsDuplicate(int ind)
+{
+	u64 titleId = GetTitleId(ind);
+	if(!titleId)
+		return false;
+
+	std::unordered_map<u64, std::vector<int> >::const_iterator itr = TitleFolders.find(titleId);
+	return (itr != TitleFolders.end() && itr->second.size() > 1);
+}
+
+int CFolderList::GetNewest(int ind)
+{
+	if(!IsDuplicate(ind))
+		return ind;
+
+	const std::vector<int> & folders = TitleFolders[Folders.at(ind)->titleId];
+	int newest = folders[0];
+
+	for(u32 i = 1; i < folders.size(); i++)
+	{
+		if(Folders.at(folders[i])->manifest.getVersion() > Folders.at(newest)->manifest.getVersion())
+			newest = folders[i];
+	}
+
+	return newest;
+}
+
+void CFolderList::ReadTitleId(FolderStruct * folder)
+{
+	if(folder->manifest.isValid())
+	{
+		folder->titleId = folder->manifest.getTitleId();
+		return;
+	}
+
+	//! without a TMD the ticket still tells which title it is
+	CFile file(folder->path + "/title.tik", CFile::ReadOnly);
+	u8 data[8];
+
+	if(file.isOpen() && file.seek(TICKET_TITLE_ID_OFFSET, SEEK_SET) >= 0 && file.read(data, sizeof(data)) == sizeof(data))
+	{
+		u64 titleId = 0;
+		for(u32 i = 0; i < sizeof(data); i++)
+			titleId = (titleId << 8) | data[i];
+
+		folder->titleId = titleId;
+	}
+}
+
+void CFolderList::BuildTitleIndex()
+{
+	TitleFolders.clear();
+
+	for(u32 i = 0; i < Folders.size(); i++)
 	{
-		if(Folders.at(i)->sequence == 1)
-			found = i;
+		if(Folders.at(i)->titleId)
+			TitleFolders[Folders.at(i)->titleId].push_back(i);
 	}
+}
+
+std::vector<int> CFolderList::GetSelectedList()
+{
+	std::vector<int> selected;
+	selected.reserve(selectedCount);
+	
+	for(FolderStruct * folder = firstSelected; folder; folder = folder->nextSelected)
+		selected.push_back(folder->index);
 	
-	return found;
+	return selected;
 }
 
-void CFolderList::AddSequence(int ind)
+void CFolderList::LinkSelected(FolderStruct * folder)
 {
-	if(!Folders.size())
+	if(folder->selected)
 		return;
 	
-	Folders.at(ind)->sequence = GetSelectedCount();
+	folder->selected = true;
+	folder->prevSelected = lastSelected;
+	folder->nextSelected = NULL;
+	
+	if(lastSelected)
+		lastSelected->nextSelected = folder;
+	else
+		firstSelected = folder;
+	
+	lastSelected = folder;
+	selectedCount++;
 }
 
-void CFolderList::RemoveSequence(int ind)
+void CFolderList::UnlinkSelected(FolderStruct * folder)
 {
-	if(!Folders.size())
+	if(!folder->selected)
 		return;
 	
-	int removedSequence = Folders.at(ind)->sequence;
-	Folders.at(ind)->sequence = 0;
+	if(folder->prevSelected)
+		folder->prevSelected->nextSelected = folder->nextSelected;
+	else
+		firstSelected = folder->nextSelected;
 	
-	for(u32 i = 0; i < Folders.size(); i++)
-	{
-		if(Folders.at(i)->sequence > removedSequence)
-			Folders.at(i)->sequence = Folders.at(i)->sequence-1;
-	}
+	if(folder->nextSelected)
+		folder->nextSelected->prevSelected = folder->prevSelected;
+	else
+		lastSelected = folder->prevSelected;
+	
+	folder->selected = false;
+	folder->prevSelected = NULL;
+	folder->nextSelected = NULL;
+	selectedCount--;
 }
 
 void CFolderList::Click(int ind)
@@ -158,68 +295,355 @@ void CFolderList::Click(int ind)
 
 void CFolderList::Reset()
 {
+	StopSizes();
+	Unsized.clear();
+	
+	for(u32 i = 0; i < Folders.size(); i++)
+		delete Folders[i];
+	
 	Folders.clear();
+	TitleFolders.clear();
+	
+	firstSelected = NULL;
+	lastSelected = NULL;
+	selectedCount = 0;
 }
 
 int CFolderList::GetSelectedCount()
 {
-	int selectedCount = 0;
+	return selectedCount;
+}
+
+void CFolderList::ReadFolder(FolderStruct * folder, ScanIndex & index)
+{
+	//! a stat of the TMD is much cheaper than reading and parsing it
+	u64 stampTime, stampSize;
+	ScanIndex::getStamp(folder->path + "/title.tmd", stampTime, stampSize);
+
+	//! without a TMD the title id comes from the ticket, so the ticket is what has to stay the same
+	if(!stampTime && !stampSize)
+		ScanIndex::getStamp(folder->path + "/title.tik", stampTime, stampSize);
+
+	if(!index.lookup(folder->name, stampTime, stampSize, folder->manifest, folder->titleId))
+	{
+		folder->manifest.load(folder->path + "/title.tmd");
+		ReadTitleId(folder);
+
+		index.set(folder->name, stampTime, stampSize, folder->manifest, folder->titleId);
+	}
+
+	//! the TMD knows the size of every content, without one the size worker sums up the .app files
+	folder->sizeKnown = folder->manifest.isValid();
+	folder->size = folder->sizeKnown ? folder->manifest.getTotalSize() : 0;
+}
+
+void CFolderList::Scan()
+{
+	std::string root = "fs:/vol/external01/install";
 	
-	for(u32 i = 0; i < Folders.size(); i++)
+	ScanIndex index;
+	index.load();
+	
+	//! titles can be grouped in subfolders, the scan stops at folders with a title in them
+	DirList dir(root, NULL, DirList::Dirs | DirList::CheckSubfolders);
+	
+	if(dir.IsRootTitle())
 	{
-		if(Folders.at(i)->selected)
-			selectedCount++;
+		FolderStruct * folder = NewFolder();
+		folder->name = "install";
+		folder->path = root;
+		ReadFolder(folder, index);
+		
+		scanMutex.lock();
+		Pending.push_back(folder);
+		scanMutex.unlock();
+	}
+	else
+	{
+		for(int i = 0; i < dir.GetFilecount() && !scanAbort; i++)
+		{
+			if(!dir.IsTitle(i))
+				continue;
+			
+			//! the path below install/ tells titles with the same folder name apart
+			std::string path = dir.GetFilepath(i);
+			
+			FolderStruct * folder = NewFolder();
+			folder->name = path.substr(root.size() + 1);
+			folder->path = path;
+			ReadFolder(folder, index);
+			
+			//! every folder is handed over as soon as it is read so the first rows show up early
+			scanMutex.lock();
+			Pending.push_back(folder);
+			scanMutex.unlock();
+		}
 	}
 	
-	return selectedCount;
+	if(!scanAbort)
+		index.save();
+}
+
+void CFolderList::ScanThread(CThread *thread, void *arg)
+{
+	CFolderList * list = (CFolderList *) arg;
+	
+	list->Scan();
+	
+	list->scanMutex.lock();
+	list->scanDone = true;
+	list->scanMutex.unlock();
+}
+
+void CFolderList::StartScan()
+{
+	WaitScan();
+	Reset();
+	
+	scanDone = false;
+	scanAbort = false;
+	
+	//! keep the GUI core free, reading the TMDs is what takes long
+	scanThread = CThread::create(CFolderList::ScanThread, this, CThread::eAttributeAffCore2 | CThread::eAttributePinnedAff);
+	if(!scanThread)
+	{
+		//! no worker, scan right here and let Fetch() pick up the folders
+		Scan();
+		scanDone = true;
+		return;
+	}
+	
+	scanThread->resumeThread();
+}
+
+int CFolderList::Fetch()
+{
+	scanMutex.lock();
+	std::vector<FolderStruct *> found;
+	found.swap(Pending);
+	bool done = scanDone;
+	scanMutex.unlock();
+	
+	for(u32 i = 0; i < found.size(); i++)
+	{
+		found[i]->index = Folders.size();
+		Folders.push_back(found[i]);
+		
+		if(!found[i]->sizeKnown)
+			Unsized.push_back(found[i]->index);
+		
+		if(found[i]->titleId)
+			TitleFolders[found[i]->titleId].push_back(Folders.size() - 1);
+	}
+	
+	//! the worker is done, joining it does not block anymore
+	if(done && scanThread)
+	{
+		delete scanThread;
+		scanThread = NULL;
+	}
+	
+	//! sizes are summed up once the scan is done so the two do not compete for the card
+	if(!scanThread && !sizeThread && !Unsized.empty() && !scanAbort)
+		StartSizes();
+	
+	return found.size();
+}
+
+void CFolderList::WaitScan()
+{
+	if(scanThread)
+	{
+		delete scanThread;
+		scanThread = NULL;
+	}
+	
+	Fetch();
+}
+
+bool CFolderList::IsScanning()
+{
+	scanMutex.lock();
+	bool scanning = (scanThread != NULL) && !scanDone;
+	scanMutex.unlock();
+	
+	return scanning;
+}
+
+void CFolderList::SizeThread(CThread *thread, void *arg)
+{
+	CFolderList * list = (CFolderList *) arg;
+	
+	for(u32 i = 0; i < list->SizeJobs.size() && !list->sizeAbort; i++)
+	{
+		const SizeJob & job = list->SizeJobs[i];
+		
+		DirList dir(job.path, ".app", DirList::Files | DirList::Stats);
+		
+		u64 size = 0;
+		for(int n = 0; n < dir.GetFilecount(); n++)
+			size += dir.GetFilesize(n);
+		
+		list->scanMutex.lock();
+		list->SizeResults.push_back(std::make_pair(job.index, size));
+		list->scanMutex.unlock();
+	}
+	
+	list->scanMutex.lock();
+	list->sizeDone = true;
+	list->scanMutex.unlock();
+}
+
+void CFolderList::StartSizes()
+{
+	SizeJobs.clear();
+	
+	for(u32 i = 0; i < Unsized.size(); i++)
+	{
+		SizeJob job;
+		job.index = Unsized[i];
+		job.path = Folders.at(Unsized[i])->path;
+		SizeJobs.push_back(job);
+	}
+	
+	Unsized.clear();
+	sizeDone = false;
+	sizeAbort = false;
+	
+	//! the scan worker is done with core 2 by now, the low priority keeps it out of the way of everything else
+	sizeThread = CThread::create(CFolderList::SizeThread, this, CThread::eAttributeAffCore2 | CThread::eAttributePinnedAff, 30);
+	if(!sizeThread)
+	{
+		//! the sizes stay unknown, they are only shown in the list
+		SizeJobs.clear();
+		return;
+	}
+	
+	sizeThread->resumeThread();
+}
+
+void CFolderList::StopSizes()
+{
+	if(sizeThread)
+	{
+		sizeAbort = true;
+		delete sizeThread;
+		sizeThread = NULL;
+	}
+	
+	SizeJobs.clear();
+	SizeResults.clear();
+}
+
+std::vector<int> CFolderList::FetchSizes()
+{
+	scanMutex.lock();
+	std::vector< std::pair<int, u64> > results;
+	results.swap(SizeResults);
+	bool done = sizeDone;
+	scanMutex.unlock();
+	
+	std::vector<int> sized;
+	
+	for(u32 i = 0; i < results.size(); i++)
+	{
+		FolderStruct * folder = Folders.at(results[i].first);
+		folder->size = results[i].second;
+		folder->sizeKnown = true;
+		sized.push_back(results[i].first);
+	}
+	
+	if(done && sizeThread)
+	{
+		delete sizeThread;
+		sizeThread = NULL;
+		SizeJobs.clear();
+	}
+	
+	return sized;
 }
 
 int CFolderList::Get()
 {
+	WaitScan();
 	Reset();
+	Scan();
+	Fetch();
+	
+	return Folders.size();
+}
+
+bool CFolderList::Refresh(Changes & changes)
+{
+	WaitScan();
+	StopSizes();
+	Unsized.clear();
 	
-	DirList dir("fs:/vol/external01/install", NULL, DirList::Dirs);
+	std::vector<FolderStruct *> oldFolders;
+	oldFolders.swap(Folders);
+	TitleFolders.clear();
 	
-	int cnt = dir.GetFilecount();
-	if(cnt > 0)
+	//! the old folders keep their links until the selection is moved over
+	FolderStruct * oldSelected = firstSelected;
+	firstSelected = NULL;
+	lastSelected = NULL;
+	selectedCount = 0;
+	
+	Scan();
+	Fetch();
+	
+	std::unordered_map<std::string, int> newIndex;
+	for(u32 i = 0; i < Folders.size(); i++)
+		newIndex[Folders[i]->path] = i;
+	
+	changes.oldToNew.assign(oldFolders.size(), -1);
+	changes.added.clear();
+	changes.updated.clear();
+	
+	std::vector<bool> listed(Folders.size(), false);
+	bool changed = (oldFolders.size() != Folders.size());
+	
+	for(u32 i = 0; i < oldFolders.size(); i++)
 	{
-		int j = 0;
+		FolderStruct * old = oldFolders[i];
+		std::unordered_map<std::string, int>::const_iterator itr = newIndex.find(old->path);
 		
-		for(int i = 0; i < cnt; i++)
+		if(itr != newIndex.end())
 		{
-			std::string path = dir.GetFilepath(i);
-			path += "/title.tik";
+			int n = itr->second;
+			FolderStruct * folder = Folders[n];
 			
-			CFile * file = new CFile(path, CFile::ReadOnly);
+			if(folder->titleId != old->titleId || folder->manifest.getVersion() != old->manifest.getVersion()
+			   || folder->manifest.getTotalSize() != old->manifest.getTotalSize())
+				changes.updated.push_back(n);
 			
-			if(file->isOpen())
-			{
-				AddFolder();
-				Folders.at(j)->name = dir.GetFilename(i);
-				Folders.at(j)->path = dir.GetFilepath(i);
-				Folders.at(j)->selected = false;
-				Folders.at(j)->sequence = 0;
-				
-				j++;
-			}
+			changes.oldToNew[i] = n;
+			listed[n] = true;
 			
-			delete file;
+			if(n != (int) i)
+				changed = true;
 		}
 	}
-	else
+	
+	//! selected folders that are still there keep their install order
+	for(FolderStruct * old = oldSelected; old; old = old->nextSelected)
 	{
-		dir.LoadPath("fs:/vol/external01/install", ".tik", DirList::Files);
-		
-		cnt = dir.GetFilecount();
-		if(cnt > 0)
-		{
-			AddFolder();
-			Folders.at(0)->name = "install";
-			Folders.at(0)->path = "fs:/vol/external01/install";
-			Folders.at(0)->selected = false;
-			Folders.at(0)->sequence = 0;
-		}
+		if(changes.oldToNew[old->index] >= 0)
+			LinkSelected(Folders[changes.oldToNew[old->index]]);
 	}
 	
-	return Folders.size();
+	for(u32 i = 0; i < oldFolders.size(); i++)
+		delete oldFolders[i];
+	
+	for(u32 i = 0; i < Folders.size(); i++)
+	{
+		if(!listed[i])
+			changes.added.push_back(i);
+	}
+	
+	std::sort(changes.updated.begin(), changes.updated.end());
+	
+	BuildTitleIndex();
+	
+	return changed || !changes.added.empty() || !changes.updated.empty();
 }
@@ -30,43 +30,140 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include "TitleManifest.h"
+#include "ScanIndex.h"
+#include "system/CThread.h"
+#include "system/CMutex.h"
 
 
 class CFolderList
 {
 	public:
-		CFolderList() { };
-		~CFolderList() { Reset(); };
+		//! what a Refresh() changed, indices are the ones after the refresh
+		typedef struct
+		{
+			//! new index of every folder listed before, -1 if it is gone
+			std::vector<int> oldToNew;
+			//! folders that were not listed before
+			std::vector<int> added;
+			//! folders that are still there but hold a different title or version now
+			std::vector<int> updated;
+		} Changes;
+		
+		CFolderList() : firstSelected(NULL), lastSelected(NULL), selectedCount(0), scanThread(NULL), scanDone(false), scanAbort(false), sizeThread(NULL), sizeDone(false), sizeAbort(false) { };
+		~CFolderList() { scanAbort = true; WaitScan(); Reset(); };
 		
 		int Get();
+		//! Scans on a worker thread, the folders found show up in the list with Fetch()
+		void StartScan();
+		//! Moves the folders the worker found since the last call into the list.
+		//! Only call it from the thread that uses the list, returns how many were added.
+		int Fetch();
+		//! Blocks until the worker is done and fetches what is left
+		void WaitScan();
+		//! true while the worker is still looking for folders
+		bool IsScanning();
+		//! Applies the content sizes the size worker found since the last call,
+		//! returns the folders that got a size
+		std::vector<int> FetchSizes();
+		//! true while sizes of folders without a TMD are still being summed up
+		bool IsSizing() { return sizeThread != NULL; };
+		//! Stops the size worker, the sizes that are left stay unknown until the next Refresh()
+		void StopSizes();
+		//! Scans again and keeps selection and install order of the folders that are still there.
+		//! Returns false if the list did not change.
+		bool Refresh(Changes & changes);
 		void Reset();
 		void AddFolder();
 		int GetCount() { return Folders.size(); };
 		int GetSelectedCount();
-		std::string GetName(int ind);
-		std::string GetPath(int ind);
+		//! the references stay valid until the list is scanned again
+		const std::string & GetName(int ind);
+		const std::string & GetPath(int ind);
+		const TitleManifest & GetManifest(int ind);
+		u64 GetTitleId(int ind);
+		//! size of all contents, from the TMD or the .app files, 0 until it is known
+		u64 GetSize(int ind);
+		bool IsSizeKnown(int ind);
+		//! true if another folder holds the same title
+		bool IsDuplicate(int ind);
+		//! the folder with the highest version of the title in ind
+		int GetNewest(int ind);
 		bool IsSelected(int ind);
 		void Select(int ind);
 		void UnSelect(int ind);
 		void SelectAll();
 		void UnSelectAll();
+		//! the folder selected first, the next one to install
 		int GetFirstSelected();
+		//! selected folders in the order they were selected
+		std::vector<int> GetSelectedList();
 		
 		void Click(int ind);
 		
 	protected:
-		void AddSequence(int index);
-		void RemoveSequence(int index);
-		
 		typedef struct _FolderStruct
 		{
 			std::string name;
 			std::string path;
 			bool selected;
-			int sequence;
+			//! position in Folders
+			int index;
+			//! the selected folders are linked in the order they were selected
+			struct _FolderStruct * prevSelected;
+			struct _FolderStruct * nextSelected;
+			TitleManifest manifest;
+			//! from the TMD, or from the ticket if there is no valid TMD
+			u64 titleId;
+			u64 size;
+			bool sizeKnown;
 		} FolderStruct;
 		
+		typedef struct
+		{
+			int index;
+			std::string path;
+		} SizeJob;
+		
+		static FolderStruct * NewFolder();
+		static void ScanThread(CThread *thread, void *arg);
+		static void SizeThread(CThread *thread, void *arg);
+		//! Sums up the .app files of the folders without a TMD on a low priority worker
+		void StartSizes();
+		
+		//! appends a folder to the end of the selection
+		void LinkSelected(FolderStruct * folder);
+		void UnlinkSelected(FolderStruct * folder);
+		void ReadTitleId(FolderStruct * folder);
+		//! Gets manifest and title id from the scan index or from the folder
+		void ReadFolder(FolderStruct * folder, ScanIndex & scanIndex);
+		//! Passes the title folders below the install folder to Fetch()
+		void Scan();
+		void BuildTitleIndex();
+		
 		std::vector<FolderStruct *> Folders;
+		//! folders by title id, only titles in more than one folder have more than one entry
+		std::unordered_map<u64, std::vector<int> > TitleFolders;
+		
+		FolderStruct * firstSelected;
+		FolderStruct * lastSelected;
+		int selectedCount;
+		
+		//! folders the scan found that are not fetched yet
+		std::vector<FolderStruct *> Pending;
+		CMutex scanMutex;
+		CThread * scanThread;
+		bool scanDone;
+		volatile bool scanAbort;
+		
+		//! folders the size worker still has to do, it owns the jobs while it runs
+		std::vector<int> Unsized;
+		std::vector<SizeJob> SizeJobs;
+		std::vector< std::pair<int, u64> > SizeResults;
+		CThread * sizeThread;
+		bool sizeDone;
+		volatile bool sizeAbort;
 };
 
 #endif
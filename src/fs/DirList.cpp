@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <string>
 #include <algorithm>
 #include <sys/stat.h>
@@ -39,10 +40,22 @@ DirList::DirList()
 {
 	Flags = 0;
 	Filter = 0;
+	MaxDepth = DefaultMaxDepth;
+	RootIsTitle = false;
+	KeyOffset = 0;
+	NameIndexValid = false;
+	PoolBlockUsed = 0;
+	PoolBlockFree = 0;
 }
 
 DirList::DirList(const std::string & path, const char *filter, u32 flags)
 {
+	MaxDepth = DefaultMaxDepth;
+	RootIsTitle = false;
+	KeyOffset = 0;
+	NameIndexValid = false;
+	PoolBlockUsed = 0;
+	PoolBlockFree = 0;
 	this->LoadPath(path, filter, flags);
 	this->SortList();
 }
@@ -77,6 +90,68 @@ bool DirList::InternalLoadPath(std::string &folderpath)
 	if(folderpath.size() < 3)
 		return false;
 
+	typedef struct
+	{
+		std::string path;
+		int depth;
+		//! entry of the folder in the list, -1 if it was filtered out
+		int entry;
+	} PendingDir;
+
+	//! walk the tree with an explicit stack, every directory is opened exactly once
+	std::vector<PendingDir> stack;
+	std::vector< std::pair<std::string, int> > subfolders;
+
+	PendingDir root;
+	root.path = folderpath;
+	root.depth = 0;
+	root.entry = -1;
+	stack.push_back(root);
+
+	bool result = false;
+	RootIsTitle = false;
+	KeyOffset = folderpath.size() + 1;
+
+	while(!stack.empty())
+	{
+		PendingDir current = stack.back();
+		stack.pop_back();
+
+		bool isTitle = false;
+		subfolders.clear();
+
+		if(!ReadDirectory(current.path, isTitle, subfolders))
+			continue;
+
+		if(current.depth == 0)
+		{
+			result = true;
+			RootIsTitle = isTitle;
+		}
+
+		if(current.entry >= 0)
+			FileInfo[current.entry].isTitle = isTitle;
+
+		//! a title folder is a leaf, there is nothing to install below it
+		if(!(Flags & CheckSubfolders) || isTitle || current.depth >= MaxDepth)
+			continue;
+
+		//! push in reverse so the folders are read in directory order
+		for(int i = subfolders.size() - 1; i >= 0; i--)
+		{
+			PendingDir next;
+			next.path = current.path + "/" + subfolders[i].first;
+			next.depth = current.depth + 1;
+			next.entry = subfolders[i].second;
+			stack.push_back(next);
+		}
+	}
+
+	return result;
+}
+
+bool DirList::ReadDirectory(const std::string &folderpath, bool &isTitle, std::vector< std::pair<std::string, int> > &subfolders)
+{
 	struct dirent *dirent = NULL;
 	DIR *dir = NULL;
 
@@ -86,45 +161,47 @@ bool DirList::InternalLoadPath(std::string &folderpath)
 
 	while ((dirent = readdir(dir)) != 0)
 	{
-		bool isDir = dirent->d_type & DT_DIR;
 		const char *filename = dirent->d_name;
+		bool isDir = (dirent->d_type == DT_DIR);
+
+		//! only stat the entry if the file system does not tell the type
+		if(dirent->d_type == DT_UNKNOWN)
+		{
+			struct stat st;
+			std::string filepath = folderpath + "/" + filename;
+			isDir = (stat(filepath.c_str(), &st) == 0) && S_ISDIR(st.st_mode);
+		}
 
 		if(isDir)
 		{
 			if(strcmp(filename,".") == 0 || strcmp(filename,"..") == 0)
 				continue;
-
-			if(Flags & CheckSubfolders)
-			{
-				int length = folderpath.size();
-				if(length > 2 && folderpath[length-1] != '/')
-					folderpath += '/';
-				folderpath += filename;
-				InternalLoadPath(folderpath);
-				folderpath.erase(length);
-			}
-
-			if(!(Flags & Dirs))
-				continue;
 		}
-		else if(!(Flags & Files))
+		else if(strcasecmp(filename, "title.tmd") == 0 || strcasecmp(filename, "title.tik") == 0)
 		{
-			continue;
+			isTitle = true;
 		}
 
-		if(Filter)
+		u32 count = FileInfo.size();
+
+		if(isDir ? (Flags & Dirs) : (Flags & Files))
 		{
-			char * fileext = strrchr(filename, '.');
-			if(!fileext)
-				continue;
+			if(Filter)
+			{
+				const char * fileext = strrchr(filename, '.');
 
-			if(strtokcmp(fileext, Filter, ",") == 0)
+				if(fileext && strtokcmp(fileext, Filter, ",") == 0)
+					AddEntrie(folderpath, filename, isDir);
+			}
+			else
+			{
 				AddEntrie(folderpath, filename, isDir);
+			}
 		}
-		else
-		{
-			AddEntrie(folderpath, filename, isDir);
-		}
+
+		//! remember where the folder is listed so it can be flagged as title later
+		if(isDir && (Flags & CheckSubfolders))
+			subfolders.push_back(std::make_pair(std::string(filename), (FileInfo.size() > count) ? (int)count : -1));
 	}
 	closedir(dir);
 
@@ -140,31 +217,77 @@ void DirList::AddEntrie(const std::string &filepath, const char * filename, bool
 	if(filename[0] == '.' && filename[1] == '_')
 		return;
 
-	int pos = FileInfo.size();
+	u32 length = filepath.size()+strlen(filename)+1;
+
+	//! the sort key is folded once here instead of in every comparison
+	u32 keyLength = (length > KeyOffset) ? (length - KeyOffset) : length;
+	char * path = AllocPath(length + 1 + keyLength + 1);
+	if(!path)
+		return;
 
-	FileInfo.resize(pos+1);
+	sprintf(path, "%s/%s", filepath.c_str(), filename);
+
+	char * key = path + length + 1;
+	const char * src = path + (length - keyLength);
+	for(u32 i = 0; i <= keyLength; i++)
+		key[i] = tolower((u8)src[i]);
+
+	DirEntry entry;
+	entry.FilePath = path;
+	entry.SortKey = key;
+	entry.isDir = isDir;
+	entry.isTitle = false;
+	entry.statDone = false;
+	entry.size = 0;
+	entry.mtime = 0;
+	FileInfo.push_back(entry);
+	NameIndexValid = false;
+
+	if(Flags & Stats)
+		LoadStat(FileInfo.back());
+}
 
-	FileInfo[pos].FilePath = (char *) malloc(filepath.size()+strlen(filename)+2);
-	if(!FileInfo[pos].FilePath)
+char * DirList::AllocPath(u32 size)
+{
+	if(size > PoolBlockFree)
 	{
-		FileInfo.resize(pos);
-		return;
+		//! every new block is twice the size of the last one up to the maximum
+		u32 blockSize = PoolBlockSize << std::min(PoolBlocks.size(), (size_t)4);
+		if(blockSize > PoolMaxBlockSize)
+			blockSize = PoolMaxBlockSize;
+		if(blockSize < size)
+			blockSize = size;
+
+		char * block = (char *) malloc(blockSize);
+		if(!block)
+			return NULL;
+
+		PoolBlocks.push_back(block);
+		PoolBlockUsed = 0;
+		PoolBlockFree = blockSize;
 	}
 
-	sprintf(FileInfo[pos].FilePath, "%s/%s", filepath.c_str(), filename);
-	FileInfo[pos].isDir = isDir;
+	char * ptr = PoolBlocks.back() + PoolBlockUsed;
+	PoolBlockUsed += size;
+	PoolBlockFree -= size;
+
+	return ptr;
 }
 
 void DirList::ClearList()
 {
-	for(u32 i = 0; i < FileInfo.size(); ++i)
-	{
-		if(FileInfo[i].FilePath)
-			free(FileInfo[i].FilePath);
-	}
+	for(u32 i = 0; i < PoolBlocks.size(); ++i)
+		free(PoolBlocks[i]);
+
+	std::vector<char *>().swap(PoolBlocks);
+	PoolBlockUsed = 0;
+	PoolBlockFree = 0;
 
 	FileInfo.clear();
 	std::vector<DirEntry>().swap(FileInfo);
+
+	NameIndex.clear();
+	NameIndexValid = false;
 }
 
 const char * DirList::GetFilename(int ind) const
@@ -175,41 +298,104 @@ const char * DirList::GetFilename(int ind) const
 	return FullpathToFilename(FileInfo[ind].FilePath);
 }
 
-static bool SortCallback(const DirEntry & f1, const DirEntry & f2)
+//! compares runs of digits by their value, everything else byte wise
+static int NaturalCompare(const char *a, const char *b)
 {
-	if(f1.isDir && !(f2.isDir)) return true;
-	if(!(f1.isDir) && f2.isDir) return false;
+	while(*a && *b)
+	{
+		if(isdigit((u8)*a) && isdigit((u8)*b))
+		{
+			while(*a == '0') a++;
+			while(*b == '0') b++;
 
-	if(f1.FilePath && !f2.FilePath) return true;
-	if(!f1.FilePath) return false;
+			const char *startA = a;
+			const char *startB = b;
+			while(isdigit((u8)*a)) a++;
+			while(isdigit((u8)*b)) b++;
 
-	if(strcasecmp(f1.FilePath, f2.FilePath) > 0)
-		return false;
+			//! without leading zeros the longer number is the bigger one
+			int lenA = a - startA;
+			int lenB = b - startB;
+			if(lenA != lenB)
+				return lenA - lenB;
 
-	return true;
+			int res = memcmp(startA, startB, lenA);
+			if(res != 0)
+				return res;
+
+			continue;
+		}
+
+		if(*a != *b)
+			return (u8)*a - (u8)*b;
+
+		a++;
+		b++;
+	}
+
+	return (u8)*a - (u8)*b;
+}
+
+static bool SortCallback(const DirEntry & f1, const DirEntry & f2)
+{
+	if(f1.isDir != f2.isDir)
+		return f1.isDir;
+
+	int res = NaturalCompare(f1.SortKey, f2.SortKey);
+	if(res != 0)
+		return res < 0;
+
+	//! "Game 01" and "Game 1" or names only differing in case keep a fixed order
+	return strcmp(f1.FilePath, f2.FilePath) < 0;
 }
 
 void DirList::SortList()
 {
 	if(FileInfo.size() > 1)
 		std::sort(FileInfo.begin(), FileInfo.end(), SortCallback);
+
+	NameIndexValid = false;
 }
 
 void DirList::SortList(bool (*SortFunc)(const DirEntry &a, const DirEntry &b))
 {
 	if(FileInfo.size() > 1)
 		std::sort(FileInfo.begin(), FileInfo.end(), SortFunc);
+
+	NameIndexValid = false;
 }
 
-u64 DirList::GetFilesize(int index) const
+void DirList::LoadStat(const DirEntry &entry) const
 {
+	if(entry.statDone)
+		return;
+
+	entry.statDone = true;
+
 	struct stat st;
-	const char *path = GetFilepath(index);
+	if(stat(entry.FilePath, &st) != 0)
+		return;
+
+	entry.size = st.st_size;
+	entry.mtime = st.st_mtime;
+}
 
-	if(!path || stat(path, &st) != 0)
+u64 DirList::GetFilesize(int index) const
+{
+	if(!valid(index))
 		return 0;
 
-	return st.st_size;
+	LoadStat(FileInfo[index]);
+	return FileInfo[index].size;
+}
+
+time_t DirList::GetModTime(int index) const
+{
+	if(!valid(index))
+		return 0;
+
+	LoadStat(FileInfo[index]);
+	return FileInfo[index].mtime;
 }
 
 int DirList::GetFileIndex(const char *filename) const
@@ -217,11 +403,25 @@ int DirList::GetFileIndex(const char *filename) const
 	if(!filename)
 		return -1;
 
-	for (u32 i = 0; i < FileInfo.size(); ++i)
+	if(!NameIndexValid)
 	{
-		if (strcasecmp(GetFilename(i), filename) == 0)
-			return i;
+		NameIndex.clear();
+		NameIndex.reserve(FileInfo.size());
+
+		//! emplace keeps the first entry of names that show up in several folders
+		for (u32 i = 0; i < FileInfo.size(); ++i)
+			NameIndex.emplace(FullpathToFilename(FileInfo[i].SortKey), i);
+
+		NameIndexValid = true;
 	}
 
-	return -1;
+	std::string name(filename);
+	for(u32 i = 0; i < name.size(); ++i)
+		name[i] = tolower((u8)name[i]);
+
+	std::unordered_map<std::string, int>::const_iterator itr = NameIndex.find(name);
+	if(itr == NameIndex.end())
+		return -1;
+
+	return itr->second;
 }
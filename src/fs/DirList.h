@@ -29,12 +29,24 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <time.h>
 #include "common/types.h"
 
 typedef struct
 {
-	char * FilePath;
+	//! points into the string pool of the list, valid until the list is destroyed
+	const char * FilePath;
+	//! lower case path below the loaded folder, the default sort compares only this
+	const char * SortKey;
 	bool isDir;
+	//! directory holds a title.tmd or title.tik, only known when it was scanned
+	bool isTitle;
+	//! size and modification time are read with one stat on the first query
+	//! or during the scan with the Stats flag
+	mutable bool statDone;
+	mutable u64 size;
+	mutable time_t mtime;
 } DirEntry;
 
 class DirList
@@ -59,16 +71,27 @@ public:
 	//! Get the a filesize of the list
 	//!\param list index
 	u64 GetFilesize(int index) const;
+	//! Get the modification time of a list entry, 0 if unknown
+	//!\param list index
+	time_t GetModTime(int index) const;
 	//! Is index a dir or a file
 	//!\param list index
 	bool IsDir(int index) const { if(!valid(index)) return false; return FileInfo[index].isDir; };
+	//! Is index a folder with a WUP title in it, only set with CheckSubfolders
+	//!\param list index
+	bool IsTitle(int index) const { if(!valid(index)) return false; return FileInfo[index].isTitle; };
+	//! Is the loaded path itself a folder with a WUP title in it
+	bool IsRootTitle() const { return RootIsTitle; };
+	//! How many levels below the path CheckSubfolders descends, set before loading
+	void SetMaxDepth(int depth) { MaxDepth = depth; };
 	//! Get the filecount of the whole list
 	int GetFilecount() const { return FileInfo.size(); };
-	//! Sort list by filepath
+	//! Sort list by the path below the loaded folder, folders first and numbers
+	//! in natural order ("Title 2" before "Title 10")
 	void SortList();
 	//! Custom sort command for custom sort functions definitions
 	void SortList(bool (*SortFunc)(const DirEntry &a, const DirEntry &b));
-	//! Get the index of the specified filename
+	//! Get the index of the specified filename, the first lookup builds a hash index
 	int GetFileIndex(const char *filename) const;
 	//! Enum for search/filter flags
 	enum
@@ -76,12 +99,22 @@ public:
 		Files = 0x01,
 		Dirs = 0x02,
 		CheckSubfolders = 0x08,
+		//! stat every listed entry during the scan, for callers that need all sizes
+		Stats = 0x10,
 	};
+	
+	static const int DefaultMaxDepth = 4;
 protected:
 	// Internal parser
 	bool InternalLoadPath(std::string &path);
+	//! Reads one directory, pushes the subfolders to descend into to subfolders
+	bool ReadDirectory(const std::string &folderpath, bool &isTitle, std::vector< std::pair<std::string, int> > &subfolders);
 	//!Add a list entrie
 	void AddEntrie(const std::string &filepath, const char * filename, bool isDir);
+	//! Returns room for size bytes in the string pool, NULL if out of memory
+	char * AllocPath(u32 size);
+	//! Reads size and modification time of an entry once
+	void LoadStat(const DirEntry &entry) const;
 	//! Clear the list
 	void ClearList();
 	//! Check if valid pos is requested
@@ -89,7 +122,22 @@ protected:
 
 	u32 Flags;
 	const char *Filter;
+	int MaxDepth;
+	bool RootIsTitle;
+	//! length of the loaded folder path including the slash, cut off for the sort keys
+	u32 KeyOffset;
 	std::vector<DirEntry> FileInfo;
+	//! lower case filename to the first entry with that name, rebuilt after the list changed
+	mutable std::unordered_map<std::string, int> NameIndex;
+	mutable bool NameIndexValid;
+
+	//! the paths are bump allocated from a few blocks instead of one malloc per entry,
+	//! blocks never move so the entries can keep plain pointers
+	static const u32 PoolBlockSize = 0x1000;
+	static const u32 PoolMaxBlockSize = 0x10000;
+	std::vector<char *> PoolBlocks;
+	u32 PoolBlockUsed;
+	u32 PoolBlockFree;
 };
 
 #endif
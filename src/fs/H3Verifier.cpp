@@ -0,0 +1,150 @@
+#include <malloc.h>
+#include <string.h>
+#include "H3Verifier.h"
+
+H3Verifier::H3Verifier()
+	: h3(NULL)
+	, h3Count(0)
+	, contentSize(0)
+	, key(NULL)
+	, contentIndex(0)
+	, block(NULL)
+	, blockFill(0)
+	, blockNumber(0)
+	, processed(0)
+	, result(H3_ERROR_INIT)
+	, failedOffset(0)
+{
+}
+
+H3Verifier::~H3Verifier()
+{
+	if(block)
+		free(block);
+}
+
+bool H3Verifier::init(const u8 * hashes, u32 h3Size, u64 size, const AESContext * titleKey, u16 index)
+{
+	if(!block)
+		block = (u8 *) memalign(0x40, BLOCK_SIZE);
+
+	h3 = hashes;
+	h3Count = h3Size / SHA1_DIGEST_SIZE;
+	contentSize = size;
+	key = titleKey;
+	contentIndex = index;
+	blockFill = 0;
+	blockNumber = 0;
+	processed = 0;
+	failedOffset = 0;
+
+	//! one H3 hash covers 16 * 16 * 16 blocks
+	u32 blocks = (contentSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	u32 needed = (blocks + HASHES_PER_LEVEL * HASHES_PER_LEVEL * HASHES_PER_LEVEL - 1) / (HASHES_PER_LEVEL * HASHES_PER_LEVEL * HASHES_PER_LEVEL);
+
+	if(!block || !h3 || h3Count < needed)
+	{
+		result = H3_ERROR_INIT;
+		return false;
+	}
+
+	result = H3_OK;
+	return true;
+}
+
+int H3Verifier::fail(int error)
+{
+	result = error;
+	failedOffset = (u64)blockNumber * BLOCK_SIZE;
+	return result;
+}
+
+int H3Verifier::verifyBlock(u8 * data)
+{
+	u8 digest[SHA1_DIGEST_SIZE];
+	u8 h0[SHA1_DIGEST_SIZE];
+
+	//! the first block of every 16 has the low byte of the content index
+	//! in byte 1 of its H0 hash, the same way CDecrypt reads it
+	u8 indexMask = (blockNumber % HASHES_PER_LEVEL == 0) ? (u8)contentIndex : 0;
+
+	if(key)
+	{
+		//! the hash header uses a zero iv, the data the first bytes of its H0 hash
+		u8 iv[16];
+		memset(iv, 0, sizeof(iv));
+		aes_cbc_decrypt(key, iv, data, data, HASH_HEADER_SIZE);
+
+		memcpy(iv, data + H0_OFFSET + (blockNumber % HASHES_PER_LEVEL) * SHA1_DIGEST_SIZE, sizeof(iv));
+		iv[1] ^= indexMask;
+		aes_cbc_decrypt(key, iv, data + HASH_HEADER_SIZE, data + HASH_HEADER_SIZE, DATA_SIZE);
+	}
+
+	memcpy(h0, data + H0_OFFSET + (blockNumber % HASHES_PER_LEVEL) * SHA1_DIGEST_SIZE, sizeof(h0));
+	h0[1] ^= indexMask;
+
+	sha1(data + HASH_HEADER_SIZE, DATA_SIZE, digest);
+	if(memcmp(digest, h0, SHA1_DIGEST_SIZE) != 0)
+		return fail(H3_ERROR_H0);
+
+	sha1(data + H0_OFFSET, HASHES_PER_LEVEL * SHA1_DIGEST_SIZE, digest);
+	if(memcmp(digest, data + H1_OFFSET + ((blockNumber / 16) % HASHES_PER_LEVEL) * SHA1_DIGEST_SIZE, SHA1_DIGEST_SIZE) != 0)
+		return fail(H3_ERROR_H1);
+
+	sha1(data + H1_OFFSET, HASHES_PER_LEVEL * SHA1_DIGEST_SIZE, digest);
+	if(memcmp(digest, data + H2_OFFSET + ((blockNumber / 256) % HASHES_PER_LEVEL) * SHA1_DIGEST_SIZE, SHA1_DIGEST_SIZE) != 0)
+		return fail(H3_ERROR_H2);
+
+	sha1(data + H2_OFFSET, HASHES_PER_LEVEL * SHA1_DIGEST_SIZE, digest);
+	if(memcmp(digest, h3 + (blockNumber / 4096) * SHA1_DIGEST_SIZE, SHA1_DIGEST_SIZE) != 0)
+		return fail(H3_ERROR_H3);
+
+	blockNumber++;
+	return H3_OK;
+}
+
+int H3Verifier::update(const u8 * data, u32 size)
+{
+	if(result != H3_OK)
+		return result;
+
+	if(processed + size > contentSize)
+	{
+		blockNumber = processed / BLOCK_SIZE;
+		return fail(H3_ERROR_SIZE);
+	}
+
+	processed += size;
+
+	while(size > 0)
+	{
+		u32 copy = BLOCK_SIZE - blockFill;
+		if(copy > size)
+			copy = size;
+
+		memcpy(block + blockFill, data, copy);
+		blockFill += copy;
+		data += copy;
+		size -= copy;
+
+		if(blockFill == BLOCK_SIZE)
+		{
+			blockFill = 0;
+			if(verifyBlock(block) != H3_OK)
+				return result;
+		}
+	}
+
+	return H3_OK;
+}
+
+int H3Verifier::finish()
+{
+	if(result != H3_OK)
+		return result;
+
+	if(blockFill != 0 || processed != contentSize)
+		return fail(H3_ERROR_SIZE);
+
+	return H3_OK;
+}
@@ -0,0 +1,72 @@
+#ifndef _H3_VERIFIER_H_
+#define _H3_VERIFIER_H_
+
+#include "common/types.h"
+#include "utils/aes.h"
+#include "utils/sha1.h"
+
+//! Checks a hashed content block by block against its .h3 hash tree.
+//! The content is fed in chunks of any size, only one 64 KiB block is
+//! buffered at a time so memory use does not depend on the content size.
+class H3Verifier
+{
+public:
+	H3Verifier();
+	virtual ~H3Verifier();
+
+	//! h3 is referenced, not copied, and has to stay valid while verifying.
+	//! With key == NULL the data is expected to be decrypted already.
+	//! contentIndex is the index of the content in the TMD, the first block
+	//! of every 16 has it mixed into its iv and H0 hash.
+	bool init(const u8 * h3, u32 h3Size, u64 contentSize, const AESContext * key, u16 contentIndex);
+	//! Feeds the next chunk of the .app file, stops at the first bad block
+	int update(const u8 * data, u32 size);
+	//! Returns an error if the content ended in the middle of a block
+	int finish();
+
+	//! file offset of the first bad block
+	u64 getFailedOffset() const { return failedOffset; }
+	u64 getProcessed() const { return processed; }
+
+	enum
+	{
+		BLOCK_SIZE = 0x10000,
+		HASH_HEADER_SIZE = 0x400,
+		DATA_SIZE = BLOCK_SIZE - HASH_HEADER_SIZE,
+		HASHES_PER_LEVEL = 16,
+		H0_OFFSET = 0x000,
+		H1_OFFSET = 0x140,
+		H2_OFFSET = 0x280
+	};
+
+	enum VerifyResult
+	{
+		H3_OK = 0,
+		H3_ERROR_H0 = -1,
+		H3_ERROR_H1 = -2,
+		H3_ERROR_H2 = -3,
+		H3_ERROR_H3 = -4,
+		H3_ERROR_SIZE = -5,
+		H3_ERROR_INIT = -6
+	};
+
+private:
+	int verifyBlock(u8 * block);
+	int fail(int error);
+
+	const u8 * h3;
+	u32 h3Count;
+	u64 contentSize;
+	const AESContext * key;
+	u16 contentIndex;
+
+	u8 * block;
+	u32 blockFill;
+	u32 blockNumber;
+	u64 processed;
+
+	int result;
+	u64 failedOffset;
+};
+
+#endif // _H3_VERIFIER_H_
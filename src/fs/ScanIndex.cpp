@@ -0,0 +1,184 @@
+#include <malloc.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "ScanIndex.h"
+#include "fs_utils.h"
+#include "utils/sha1.h"
+
+ScanIndex::ScanIndex(const std::string & indexPath)
+	: path(indexPath)
+	, changed(false)
+{
+}
+
+void ScanIndex::getStamp(const std::string & filepath, u64 & stampTime, u64 & stampSize)
+{
+	struct stat st;
+
+	if(stat(filepath.c_str(), &st) != 0)
+	{
+		stampTime = 0;
+		stampSize = 0;
+		return;
+	}
+
+	stampTime = st.st_mtime;
+	stampSize = st.st_size;
+}
+
+bool ScanIndex::load()
+{
+	loaded.clear();
+	current.clear();
+	changed = false;
+
+	u8 * buffer = NULL;
+	u32 size = 0;
+
+	if(LoadFileToMem(path.c_str(), &buffer, &size) < 0 || !buffer)
+		return false;
+
+	Header header;
+	bool result = false;
+
+	if(size >= sizeof(Header))
+	{
+		memcpy(&header, buffer, sizeof(Header));
+
+		u8 checksum[SHA1_DIGEST_SIZE];
+		const u8 * p = buffer + sizeof(Header);
+		const u8 * end = p + header.payloadSize;
+
+		if(header.magic == Magic && header.version == Version && header.payloadSize == size - sizeof(Header))
+		{
+			sha1(p, header.payloadSize, checksum);
+			result = (memcmp(checksum, header.checksum, SHA1_DIGEST_SIZE) == 0);
+		}
+
+		for(u32 i = 0; result && i < header.count; i++)
+		{
+			//! name length, name, stamp and title id
+			u16 nameSize;
+			if(end - p < (int)sizeof(nameSize))
+				break;
+
+			memcpy(&nameSize, p, sizeof(nameSize));
+			p += sizeof(nameSize);
+
+			if(end - p < (int)(nameSize + 3 * sizeof(u64)))
+				break;
+
+			std::string name((const char *) p, nameSize);
+			p += nameSize;
+
+			Entry entry;
+			memcpy(&entry.stampTime, p, sizeof(u64));
+			memcpy(&entry.stampSize, p + 8, sizeof(u64));
+			memcpy(&entry.titleId, p + 16, sizeof(u64));
+			p += 3 * sizeof(u64);
+
+			u32 used = entry.manifest.unpack(p, end - p);
+			if(!used)
+				break;
+
+			p += used;
+			loaded[name] = entry;
+		}
+
+		//! a checksum match with broken entries means a different layout, start over
+		if(result && loaded.size() != header.count)
+		{
+			loaded.clear();
+			result = false;
+		}
+	}
+
+	free(buffer);
+
+	return result;
+}
+
+bool ScanIndex::lookup(const std::string & name, u64 stampTime, u64 stampSize, TitleManifest & manifest, u64 & titleId)
+{
+	std::unordered_map<std::string, Entry>::const_iterator itr = loaded.find(name);
+	if(itr == loaded.end() || itr->second.stampTime != stampTime || itr->second.stampSize != stampSize)
+		return false;
+
+	manifest = itr->second.manifest;
+	titleId = itr->second.titleId;
+	current[name] = itr->second;
+
+	return true;
+}
+
+void ScanIndex::set(const std::string & name, u64 stampTime, u64 stampSize, const TitleManifest & manifest, u64 titleId)
+{
+	Entry & entry = current[name];
+	entry.stampTime = stampTime;
+	entry.stampSize = stampSize;
+	entry.titleId = titleId;
+	entry.manifest = manifest;
+
+	changed = true;
+}
+
+bool ScanIndex::save()
+{
+	//! folders that are gone only show up as a smaller count
+	if(!changed && current.size() == loaded.size())
+		return true;
+
+	std::vector<u8> data(sizeof(Header));
+
+	for(std::unordered_map<std::string, Entry>::const_iterator itr = current.begin(); itr != current.end(); ++itr)
+	{
+		u16 nameSize = itr->first.size();
+		const u8 * p = (const u8 *) &nameSize;
+		data.insert(data.end(), p, p + sizeof(nameSize));
+		data.insert(data.end(), itr->first.begin(), itr->first.end());
+
+		p = (const u8 *) &itr->second.stampTime;
+		data.insert(data.end(), p, p + sizeof(u64));
+		p = (const u8 *) &itr->second.stampSize;
+		data.insert(data.end(), p, p + sizeof(u64));
+		p = (const u8 *) &itr->second.titleId;
+		data.insert(data.end(), p, p + sizeof(u64));
+
+		itr->second.manifest.pack(data);
+	}
+
+	Header header;
+	header.magic = Magic;
+	header.version = Version;
+	header.count = current.size();
+	header.payloadSize = data.size() - sizeof(Header);
+	sha1(data.data() + sizeof(Header), header.payloadSize, header.checksum);
+	memcpy(&data[0], &header, sizeof(Header));
+
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if(fd < 0)
+		return false;
+
+	u32 done = 0;
+	while(done < data.size())
+	{
+		int ret = ::write(fd, data.data() + done, data.size() - done);
+		if(ret <= 0)
+			break;
+
+		done += ret;
+	}
+
+	::close(fd);
+
+	//! a half written file fails the checksum on the next load
+	if(done != data.size())
+		return false;
+
+	loaded = current;
+	changed = false;
+
+	return true;
+}
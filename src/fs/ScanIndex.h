@@ -0,0 +1,66 @@
+#ifndef _SCAN_INDEX_H_
+#define _SCAN_INDEX_H_
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "TitleManifest.h"
+
+#define SCAN_INDEX_PATH     "fs:/vol/external01/wiiu/install_index.bin"
+
+//! Cache of the title folders found by the last scan of the install folder.
+//! Parsing every title.tmd is what makes a scan slow, so the parsed manifest
+//! is kept per folder together with the size and time of its title.tmd, or
+//! of its title.tik if there is no TMD. A folder is only read again if that
+//! stamp changed.
+//!
+//! The file is a header followed by the entries, a version or checksum
+//! mismatch drops the whole cache and everything is read once more.
+class ScanIndex
+{
+public:
+	ScanIndex(const std::string & path = SCAN_INDEX_PATH);
+	virtual ~ScanIndex() {}
+
+	//! Reads the index file, returns false if there is none or it is damaged
+	bool load();
+	//! Writes the entries that were looked up or set since load() if anything changed
+	bool save();
+
+	//! Gets the cached manifest and title id of a folder if its stamp still matches
+	bool lookup(const std::string & name, u64 stampTime, u64 stampSize, TitleManifest & manifest, u64 & titleId);
+	//! Stores a folder that had to be read again
+	void set(const std::string & name, u64 stampTime, u64 stampSize, const TitleManifest & manifest, u64 titleId);
+
+	//! size and modification time of a file, both 0 if it does not exist
+	static void getStamp(const std::string & path, u64 & stampTime, u64 & stampSize);
+
+private:
+	typedef struct
+	{
+		u64 stampTime;
+		u64 stampSize;
+		u64 titleId;
+		TitleManifest manifest;
+	} Entry;
+
+	typedef struct
+	{
+		u32 magic;
+		u32 version;
+		u32 count;
+		u32 payloadSize;
+		u8 checksum[20];
+	} Header;
+
+	static const u32 Magic = 0x57555049;    // "WUPI"
+	static const u32 Version = 1;
+
+	std::string path;
+	//! entries of the file and entries of the current scan, only the latter are saved
+	std::unordered_map<std::string, Entry> loaded;
+	std::unordered_map<std::string, Entry> current;
+	bool changed;
+};
+
+#endif
@@ -0,0 +1,216 @@
+#include <string.h>
+#include <malloc.h>
+#include "TitleManifest.h"
+#include "CFile.hpp"
+
+static inline u16 read16(const u8 * p)
+{
+	return (p[0] << 8) | p[1];
+}
+
+static inline u32 read32(const u8 * p)
+{
+	return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | p[3];
+}
+
+static inline u64 read64(const u8 * p)
+{
+	return ((u64)read32(p) << 32) | read32(p + 4);
+}
+
+void TitleManifest::clear()
+{
+	valid = false;
+	titleId = 0;
+	version = 0;
+	totalSize = 0;
+	hashType = HASH_SHA1;
+	contents.clear();
+}
+
+//! the packed fields are in console byte order, the cache never leaves the card
+template <typename T>
+static inline void put(std::vector<u8> & out, T value)
+{
+	const u8 * p = (const u8 *) &value;
+	out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+static inline T get(const u8 * & p)
+{
+	T value;
+	memcpy(&value, p, sizeof(T));
+	p += sizeof(T);
+	return value;
+}
+
+//! valid, hash type, version, title id, total size, content count
+#define PACKED_HEADER_SIZE      (1 + 1 + 2 + 8 + 8 + 4)
+#define PACKED_CONTENT_SIZE     (4 + 2 + 2 + 8 + TMD_SHA1_SIZE)
+
+void TitleManifest::pack(std::vector<u8> & out) const
+{
+	put<u8>(out, valid);
+	put<u8>(out, hashType);
+	put<u16>(out, version);
+	put<u64>(out, titleId);
+	put<u64>(out, totalSize);
+	put<u32>(out, contents.size());
+
+	for(u32 i = 0; i < contents.size(); i++)
+	{
+		put<u32>(out, contents[i].id);
+		put<u16>(out, contents[i].index);
+		put<u16>(out, contents[i].type);
+		put<u64>(out, contents[i].size);
+		out.insert(out.end(), contents[i].hash, contents[i].hash + TMD_SHA1_SIZE);
+	}
+}
+
+u32 TitleManifest::unpack(const u8 * data, u32 size)
+{
+	clear();
+
+	if(!data || size < PACKED_HEADER_SIZE)
+		return 0;
+
+	const u8 * p = data;
+	bool isValid = get<u8>(p) != 0;
+	hashType = get<u8>(p);
+	version = get<u16>(p);
+	titleId = get<u64>(p);
+	totalSize = get<u64>(p);
+	u32 count = get<u32>(p);
+
+	if((size - PACKED_HEADER_SIZE) / PACKED_CONTENT_SIZE < count)
+	{
+		clear();
+		return 0;
+	}
+
+	contents.resize(count);
+
+	for(u32 i = 0; i < count; i++)
+	{
+		ContentRecord & content = contents[i];
+		content.id = get<u32>(p);
+		content.index = get<u16>(p);
+		content.type = get<u16>(p);
+		content.size = get<u64>(p);
+		memcpy(content.hash, p, TMD_SHA1_SIZE);
+		p += TMD_SHA1_SIZE;
+	}
+
+	valid = isValid;
+	return p - data;
+}
+
+u32 TitleManifest::getSignatureSize(u32 signatureType)
+{
+	//! signature type, signature and padding to 0x40
+	switch(signatureType)
+	{
+	case 0x00010000:    // RSA-4096 SHA-1
+	case 0x00010003:    // RSA-4096 SHA-256
+		return 4 + 0x200 + 0x3C;
+	case 0x00010001:    // RSA-2048 SHA-1
+	case 0x00010004:    // RSA-2048 SHA-256
+		return 4 + 0x100 + 0x3C;
+	case 0x00010002:    // ECC SHA-1
+	case 0x00010005:    // ECC SHA-256
+		return 4 + 0x3C + 0x40;
+	default:
+		return 0;
+	}
+}
+
+bool TitleManifest::parse(const u8 * data, u32 size)
+{
+	clear();
+
+	if(!data || size < 4)
+		return false;
+
+	u32 header = getSignatureSize(read32(data));
+	if(!header || size < header + TMD_CONTENT_RECORDS)
+		return false;
+
+	const u8 * tmd = data + header;
+
+	//! Wii U TMDs are version 1 and carry SHA-1 hashes, padded to 0x20 bytes
+	hashType = (tmd[TMD_VERSION] == 1) ? HASH_SHA1 : HASH_SHA256;
+	titleId = read64(tmd + TMD_TITLE_ID);
+	version = read16(tmd + TMD_TITLE_VERSION);
+
+	u32 count = read16(tmd + TMD_CONTENT_COUNT);
+	if(size < header + TMD_CONTENT_RECORDS + count * TMD_CONTENT_RECORD_SIZE)
+		return false;
+
+	contents.resize(count);
+
+	const u8 * record = tmd + TMD_CONTENT_RECORDS;
+	for(u32 i = 0; i < count; i++, record += TMD_CONTENT_RECORD_SIZE)
+	{
+		ContentRecord & content = contents[i];
+		content.id = read32(record);
+		content.index = read16(record + 0x04);
+		content.type = read16(record + 0x06);
+		content.size = read64(record + 0x08);
+		memcpy(content.hash, record + 0x10, TMD_SHA1_SIZE);
+
+		totalSize += content.size;
+	}
+
+	valid = true;
+	return true;
+}
+
+bool TitleManifest::load(const std::string & path)
+{
+	clear();
+
+	CFile file(path, CFile::ReadOnly);
+	if(!file.isOpen())
+		return false;
+
+	//! only read up to the end of the content records, the certificates are not needed
+	u8 signature[4];
+	if(file.read(signature, sizeof(signature)) != sizeof(signature))
+		return false;
+
+	u32 header = getSignatureSize(read32(signature));
+	if(!header)
+		return false;
+
+	u32 size = header + TMD_CONTENT_RECORDS;
+	if(file.size() < size)
+		return false;
+
+	u8 * buffer = (u8 *) malloc(size);
+	if(!buffer)
+		return false;
+
+	memcpy(buffer, signature, sizeof(signature));
+
+	bool result = false;
+
+	if(file.read(buffer + 4, size - 4) == (int)(size - 4))
+	{
+		u32 count = read16(buffer + header + TMD_CONTENT_COUNT);
+		u32 recordsSize = count * TMD_CONTENT_RECORD_SIZE;
+
+		u8 * tmp = (u8 *) realloc(buffer, size + recordsSize);
+		if(tmp)
+		{
+			buffer = tmp;
+
+			if(file.read(buffer + size, recordsSize) == (int)recordsSize)
+				result = parse(buffer, size + recordsSize);
+		}
+	}
+
+	free(buffer);
+
+	return result;
+}
@@ -0,0 +1,88 @@
+#ifndef _TITLE_MANIFEST_H_
+#define _TITLE_MANIFEST_H_
+
+#include <vector>
+#include <string>
+#include "common/types.h"
+
+#define TMD_SHA1_SIZE       0x14
+
+//! title.tik offsets for the common RSA-2048 signed ticket
+#define TICKET_TITLE_KEY_OFFSET     0x1BF
+#define TICKET_TITLE_ID_OFFSET      0x1DC
+
+typedef struct
+{
+	u32 id;
+	u16 index;
+	u16 type;
+	u64 size;
+	u8 hash[TMD_SHA1_SIZE];
+} ContentRecord;
+
+//! The parts of a title.tmd the installer cares about
+class TitleManifest
+{
+public:
+	TitleManifest() { clear(); }
+
+	//! Reads the header and the content records of a title.tmd file
+	bool load(const std::string & path);
+	//! Parses a TMD in place, fields are read straight from data
+	bool parse(const u8 * data, u32 size);
+	void clear();
+	//! Appends the parsed fields to out so they can be cached without the TMD
+	void pack(std::vector<u8> & out) const;
+	//! Restores what pack() wrote, returns the bytes used or 0 if data is too short
+	u32 unpack(const u8 * data, u32 size);
+
+	bool isValid() const { return valid; }
+	u64 getTitleId() const { return titleId; }
+	u32 getTitleIdHigh() const { return (u32)(titleId >> 32); }
+	u32 getTitleIdLow() const { return (u32)titleId; }
+	u16 getVersion() const { return version; }
+	//! sum of all content sizes
+	u64 getTotalSize() const { return totalSize; }
+	int getHashType() const { return hashType; }
+
+	int getContentCount() const { return contents.size(); }
+	const ContentRecord & getContent(int index) const { return contents[index]; }
+	//! hashed contents come with a .h3 hash tree file
+	static bool isHashed(const ContentRecord & content) { return (content.type & CONTENT_TYPE_HASHED) != 0; }
+
+	enum
+	{
+		HASH_SHA1,
+		HASH_SHA256
+	};
+
+	enum
+	{
+		CONTENT_TYPE_ENCRYPTED = 0x0001,
+		CONTENT_TYPE_HASHED = 0x0002
+	};
+
+	//! offsets relative to the end of the signature
+	enum
+	{
+		TMD_VERSION = 0x40,
+		TMD_TITLE_ID = 0x4C,
+		TMD_TITLE_VERSION = 0x9C,
+		TMD_CONTENT_COUNT = 0x9E,
+		TMD_CONTENT_RECORDS = 0x9C4,
+		TMD_CONTENT_RECORD_SIZE = 0x30
+	};
+
+	//! Size of the signature block in front of the TMD header, 0 if unknown
+	static u32 getSignatureSize(u32 signatureType);
+
+private:
+	bool valid;
+	u64 titleId;
+	u16 version;
+	u64 totalSize;
+	int hashType;
+	std::vector<ContentRecord> contents;
+};
+
+#endif
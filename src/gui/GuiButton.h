@@ -94,6 +94,7 @@ class GuiButton : public GuiElement
 		void update(GuiController * c);
 		
 		void check(void);
+		bool isChecked(void) const { return checked; }
 		
 		sigslot::signal2<GuiButton *, const GuiController *> selected;
 		sigslot::signal2<GuiButton *, const GuiController *> deSelected;
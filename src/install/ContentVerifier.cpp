@@ -0,0 +1,321 @@
+#include <malloc.h>
+#include <string.h>
+#include <algorithm>
+#include "ContentVerifier.h"
+#include "fs/CFile.hpp"
+#include "fs/fs_utils.h"
+#include "fs/H3Verifier.h"
+#include "utils/StringTools.h"
+#include "utils/sha1.h"
+
+static bool SortLargestFirst(const ContentRecord & a, const ContentRecord & b)
+{
+	return a.size > b.size;
+}
+
+ContentVerifier::ContentVerifier()
+	: nextJob(0)
+	, commonKeyLoaded(false)
+	, titleKeyLoaded(false)
+	, threadCount(VERIFY_THREAD_COUNT)
+	, bandwidthLimit(0)
+	, throttleLimit(0)
+	, throttleBytes(0)
+	, throttleStart(0)
+	, abortRequested(false)
+	, result(VERIFY_OK)
+	, failedContent(0)
+	, failedOffset(0)
+{
+	CFile keyFile(COMMON_KEY_PATH, CFile::ReadOnly);
+	if(keyFile.isOpen() && keyFile.read(commonKey, sizeof(commonKey)) == sizeof(commonKey))
+		commonKeyLoaded = true;
+}
+
+ContentVerifier::~ContentVerifier()
+{
+	memset(commonKey, 0, sizeof(commonKey));
+	memset(&titleKey, 0, sizeof(titleKey));
+}
+
+bool ContentVerifier::loadTitleKey()
+{
+	if(!commonKeyLoaded)
+		return false;
+
+	u8 * ticket = NULL;
+	u32 ticketSize = 0;
+
+	if(LoadFileToMem((folder + "/title.tik").c_str(), &ticket, &ticketSize) < 0)
+		return false;
+
+	bool loaded = false;
+
+	if(ticketSize >= TICKET_TITLE_ID_OFFSET + 8)
+	{
+		//! the title key is encrypted with the common key and the title id as iv
+		u8 iv[16];
+		u8 key[16];
+		memset(iv, 0, sizeof(iv));
+		memcpy(iv, ticket + TICKET_TITLE_ID_OFFSET, 8);
+
+		AESContext common;
+		aes_set_key(&common, commonKey);
+		aes_cbc_decrypt(&common, iv, ticket + TICKET_TITLE_KEY_OFFSET, key, sizeof(key));
+		aes_set_key(&titleKey, key);
+
+		memset(key, 0, sizeof(key));
+		loaded = true;
+	}
+
+	free(ticket);
+
+	return loaded;
+}
+
+int ContentVerifier::verify(const std::string & path, const TitleManifest & manifest)
+{
+	if(!manifest.isValid())
+		return VERIFY_ERROR_MANIFEST;
+
+	folder = path;
+	jobs.clear();
+	nextJob = 0;
+	abortRequested = false;
+	result = VERIFY_OK;
+	failedContent = 0;
+	failedOffset = 0;
+	throttleStart = 0;
+
+	for(int i = 0; i < manifest.getContentCount(); i++)
+		jobs.push_back(manifest.getContent(i));
+
+	//! big contents first so the workers finish at about the same time
+	std::sort(jobs.begin(), jobs.end(), SortLargestFirst);
+
+	titleKeyLoaded = loadTitleKey();
+
+	CThread * threads[VERIFY_THREAD_COUNT];
+	const int cores[VERIFY_THREAD_COUNT] = { CThread::eAttributeAffCore2, CThread::eAttributeAffCore1, CThread::eAttributeAffCore0 };
+
+	for(int i = 0; i < VERIFY_THREAD_COUNT; i++)
+	{
+		threads[i] = NULL;
+		if(i >= threadCount)
+			continue;
+
+		threads[i] = CThread::create(ContentVerifier::workerCallback, this, cores[i] | CThread::eAttributePinnedAff, 20);
+		if(threads[i])
+			threads[i]->resumeThread();
+	}
+
+	//! deleting a thread waits for it to finish
+	for(int i = 0; i < VERIFY_THREAD_COUNT; i++)
+		delete threads[i];
+
+	if(result == VERIFY_OK && abortRequested)
+		result = VERIFY_ERROR_ABORTED;
+
+	return result;
+}
+
+void ContentVerifier::workerCallback(CThread *thread, void *arg)
+{
+	((ContentVerifier *) arg)->worker();
+}
+
+void ContentVerifier::setError(int error, u32 contentId, u64 offset)
+{
+	jobMutex.lock();
+	if(result == VERIFY_OK)
+	{
+		result = error;
+		failedContent = contentId;
+		failedOffset = offset;
+	}
+	jobMutex.unlock();
+
+	//! one bad content is enough to skip the title
+	abortRequested = true;
+}
+
+void ContentVerifier::throttle(u32 bytes)
+{
+	u32 limit = bandwidthLimit;
+	if(limit == 0)
+		return;
+
+	jobMutex.lock();
+
+	//! start a new window whenever the limit changes
+	if(throttleStart == 0 || throttleLimit != limit)
+	{
+		throttleStart = OSGetTime();
+		throttleBytes = 0;
+		throttleLimit = limit;
+	}
+
+	throttleBytes += bytes;
+	OSTime due = throttleStart + OSMillisecondsToTicks(throttleBytes * 1000ULL / limit);
+
+	jobMutex.unlock();
+
+	OSTime now = OSGetTime();
+	if(due > now)
+		OSSleepTicks(due - now);
+}
+
+void ContentVerifier::worker()
+{
+	u8 * buffer = (u8 *) memalign(0x40, VERIFY_CHUNK_SIZE);
+	if(!buffer)
+	{
+		setError(VERIFY_ERROR_READ, 0, 0);
+		return;
+	}
+
+	while(!abortRequested)
+	{
+		jobMutex.lock();
+		int job = (nextJob < jobs.size()) ? (int)nextJob++ : -1;
+		jobMutex.unlock();
+
+		if(job < 0)
+			break;
+
+		u64 offset = 0;
+		int res = verifyContent(jobs[job], buffer, offset);
+		if(res != VERIFY_OK)
+			setError(res, jobs[job].id, offset);
+	}
+
+	free(buffer);
+}
+
+int ContentVerifier::loadH3(const ContentRecord & content, u8 ** h3, u32 * h3Size)
+{
+	if(LoadFileToMem((folder + strfmt("/%08X.h3", content.id)).c_str(), h3, h3Size) < 0)
+		return VERIFY_ERROR_H3;
+
+	//! for hashed contents the TMD holds the hash of the .h3 file
+	u8 digest[SHA1_DIGEST_SIZE];
+	sha1(*h3, *h3Size, digest);
+
+	if(memcmp(digest, content.hash, SHA1_DIGEST_SIZE) != 0)
+	{
+		free(*h3);
+		*h3 = NULL;
+		return VERIFY_ERROR_H3;
+	}
+
+	return VERIFY_OK;
+}
+
+int ContentVerifier::verifyContent(const ContentRecord & content, u8 * buffer, u64 & offset)
+{
+	bool hashed = TitleManifest::isHashed(content);
+	u8 * h3 = NULL;
+	u32 h3Size = 0;
+
+	if(hashed)
+	{
+		int res = loadH3(content, &h3, &h3Size);
+		if(res != VERIFY_OK)
+			return res;
+	}
+
+	int res = verifyFile(content, buffer, offset, h3, h3Size);
+
+	if(h3)
+		free(h3);
+
+	return res;
+}
+
+int ContentVerifier::verifyFile(const ContentRecord & content, u8 * buffer, u64 & offset, const u8 * h3, u32 h3Size)
+{
+	bool hashed = (h3 != NULL);
+
+	CFile file(folder + strfmt("/%08X.app", content.id), CFile::ReadOnly);
+	if(!file.isOpen())
+		return VERIFY_ERROR_MISSING;
+
+	//! contents are stored padded to the AES block size
+	u64 storedSize = (content.size + AES_BLOCK_SIZE - 1) & ~((u64)AES_BLOCK_SIZE - 1);
+	if(file.size() < storedSize)
+	{
+		offset = file.size();
+		return VERIFY_ERROR_SIZE;
+	}
+
+	bool checkHash = titleKeyLoaded && !hashed;
+	bool checkTree = titleKeyLoaded && hashed;
+
+	//! hashed contents are checked block by block against the H3 tree
+	H3Verifier tree;
+	if(checkTree && !tree.init(h3, h3Size, storedSize, &titleKey, content.index))
+		return VERIFY_ERROR_H3;
+
+	SHA1Context ctx;
+	sha1_init(&ctx);
+
+	//! unhashed contents use the content index as iv
+	u8 iv[16];
+	memset(iv, 0, sizeof(iv));
+	iv[0] = content.index >> 8;
+	iv[1] = content.index & 0xFF;
+
+	//! without the title key the contents are still read once to find unreadable sectors
+	while(offset < storedSize && !abortRequested)
+	{
+		u32 chunk = VERIFY_CHUNK_SIZE;
+		if(storedSize - offset < chunk)
+			chunk = storedSize - offset;
+
+		if(file.read(buffer, chunk) != (int)chunk)
+			return VERIFY_ERROR_READ;
+
+		throttle(chunk);
+
+		if(checkHash)
+		{
+			aes_cbc_decrypt(&titleKey, iv, buffer, buffer, chunk);
+
+			u32 hashSize = chunk;
+			if(offset + hashSize > content.size)
+				hashSize = content.size - offset;
+
+			sha1_update(&ctx, buffer, hashSize);
+		}
+		else if(checkTree && tree.update(buffer, chunk) != H3Verifier::H3_OK)
+		{
+			offset = tree.getFailedOffset();
+			return VERIFY_ERROR_HASH;
+		}
+
+		offset += chunk;
+	}
+
+	if(abortRequested)
+		return VERIFY_OK;
+
+	if(checkTree && tree.finish() != H3Verifier::H3_OK)
+	{
+		offset = tree.getFailedOffset();
+		return VERIFY_ERROR_HASH;
+	}
+
+	if(checkHash)
+	{
+		u8 digest[SHA1_DIGEST_SIZE];
+		sha1_final(&ctx, digest);
+
+		if(memcmp(digest, content.hash, SHA1_DIGEST_SIZE) != 0)
+		{
+			offset = 0;
+			return VERIFY_ERROR_HASH;
+		}
+	}
+
+	return VERIFY_OK;
+}
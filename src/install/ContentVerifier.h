@@ -0,0 +1,89 @@
+#ifndef CONTENT_VERIFIER_H_
+#define CONTENT_VERIFIER_H_
+
+#include <vector>
+#include <string>
+#include "fs/TitleManifest.h"
+#include <coreinit/time.h>
+#include "system/CThread.h"
+#include "system/CMutex.h"
+#include "utils/aes.h"
+
+//! Optional Wii U common key, without it only sizes, .h3 files and
+//! readability of the contents can be checked
+#define COMMON_KEY_PATH         "fs:/vol/external01/wiiu/common.key"
+#define VERIFY_CHUNK_SIZE       (1024 * 1024)
+#define VERIFY_THREAD_COUNT     3
+//! read rate while an install is running in parallel
+#define VERIFY_BANDWIDTH_LIMIT  (8 * 1024 * 1024)
+
+//! Checks the .app files of a title against its TMD before MCP sees them.
+//! The contents are spread over one worker per core.
+class ContentVerifier
+{
+public:
+	ContentVerifier();
+	virtual ~ContentVerifier();
+
+	//! Blocks until every content of the title is checked
+	int verify(const std::string & folder, const TitleManifest & manifest);
+	//! Makes a running verify() return early
+	void abort() { abortRequested = true; }
+
+	//! Number of workers, they are placed on core 2 first, then core 1 and core 0
+	void setThreadCount(int count) { threadCount = (count < 1) ? 1 : ((count > VERIFY_THREAD_COUNT) ? VERIFY_THREAD_COUNT : count); }
+	//! Caps the read rate of all workers together, 0 = no limit.
+	//! Can be changed while verify() is running.
+	void setBandwidthLimit(u32 bytesPerSecond) { bandwidthLimit = bytesPerSecond; }
+
+	//! content id and file offset of the first failure
+	u32 getFailedContent() const { return failedContent; }
+	u64 getFailedOffset() const { return failedOffset; }
+	bool hasCommonKey() const { return commonKeyLoaded; }
+
+	enum VerifyResult
+	{
+		VERIFY_OK = 0,
+		VERIFY_ERROR_MANIFEST = -1,
+		VERIFY_ERROR_MISSING = -2,
+		VERIFY_ERROR_SIZE = -3,
+		VERIFY_ERROR_READ = -4,
+		VERIFY_ERROR_HASH = -5,
+		VERIFY_ERROR_H3 = -6,
+		VERIFY_ERROR_ABORTED = -7
+	};
+
+private:
+	static void workerCallback(CThread *thread, void *arg);
+	void worker();
+	int verifyContent(const ContentRecord & content, u8 * buffer, u64 & offset);
+	int verifyFile(const ContentRecord & content, u8 * buffer, u64 & offset, const u8 * h3, u32 h3Size);
+	int loadH3(const ContentRecord & content, u8 ** h3, u32 * h3Size);
+	bool loadTitleKey();
+	void setError(int error, u32 contentId, u64 offset);
+	void throttle(u32 bytes);
+
+	std::string folder;
+	std::vector<ContentRecord> jobs;
+	u32 nextJob;
+
+	bool commonKeyLoaded;
+	u8 commonKey[16];
+	bool titleKeyLoaded;
+	AESContext titleKey;
+
+	int threadCount;
+	volatile u32 bandwidthLimit;
+	u32 throttleLimit;
+	u64 throttleBytes;
+	OSTime throttleStart;
+
+	volatile bool abortRequested;
+	int result;
+	u32 failedContent;
+	u64 failedOffset;
+
+	CMutex jobMutex;
+};
+
+#endif
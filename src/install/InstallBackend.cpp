@@ -0,0 +1,31 @@
+#include "InstallBackend.h"
+#include "McpInstallBackend.h"
+#include "SimInstallBackend.h"
+
+InstallBackend * InstallBackend::create()
+{
+	//! build with -DSIMULATED_INSTALL to profile the installer without touching MCP
+#ifdef SIMULATED_INSTALL
+	return new SimInstallBackend();
+#else
+	return new McpInstallBackend();
+#endif
+}
+
+bool InstallBackend::isInstallableTitle(u32 titleIdHigh, u32 titleIdLow, bool & spoofFiles)
+{
+	spoofFiles = false;
+	if ((titleIdHigh == 00050010)
+		&&(	   (titleIdLow == 0x10041000)     // JAP Version.bin
+			|| (titleIdLow == 0x10041100)     // USA Version.bin
+			|| (titleIdLow == 0x10041200)))   // EUR Version.bin
+	{
+		spoofFiles = true;
+	}
+
+	return (spoofFiles
+	   || (titleIdHigh == 0x0005000E)     // game update
+	   || (titleIdHigh == 0x00050000)     // game
+	   || (titleIdHigh == 0x0005000C)     // DLC
+	   || (titleIdHigh == 0x00050002));   // Demo
+}
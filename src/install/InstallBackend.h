@@ -0,0 +1,108 @@
+#ifndef INSTALL_BACKEND_H_
+#define INSTALL_BACKEND_H_
+
+#include <string>
+#include <coreinit/time.h>
+#include "common/types.h"
+#include "fs/TitleManifest.h"
+#include "ProgressSampler.h"
+
+//! One title of an install batch.
+//! Filled in by the queue worker ahead of time so the install thread
+//! can start the next title as soon as the previous one finished.
+typedef struct _InstallTask
+{
+	int index;
+	std::string name;
+	//! folder on the sd card as listed by CFolderList
+	std::string path;
+	//! folder as the backend addresses it
+	std::string installFolder;
+	int target;
+
+	u32 titleIdHigh;
+	u32 titleIdLow;
+	//! parsed title.tmd of the folder, invalid if it could not be read
+	TitleManifest manifest;
+
+	//! result of the preparation, see InstallBackend::InstallResult
+	int result;
+	bool prepared;
+
+	//! first bad content found by the verification, if any
+	u32 failedContent;
+	u64 failedOffset;
+
+	//! error MCP reported for the last install attempt
+	u32 installError;
+	//! raw error of the last failed backend call, kept per task since
+	//! prepare() and start() run on different threads
+	u32 lastError;
+	int retries;
+
+	//! whatever the backend needs to start the install
+	void * backendData;
+
+	//! stage timestamps
+	OSTime verifyStart;
+	OSTime verifyEnd;
+	OSTime prepareStart;
+	OSTime prepareEnd;
+	OSTime waitStart;
+	OSTime installStart;
+	OSTime installEnd;
+} InstallTask;
+
+//! The steps of installing a title. prepare() and release() are called
+//! from the queue worker, everything else from the install thread.
+class InstallBackend : public ProgressSource
+{
+public:
+	virtual ~InstallBackend() {}
+
+	//! Returns the backend selected at build time
+	static InstallBackend * create();
+
+	//! Resolves the title and allocates what start() needs
+	virtual int prepare(InstallTask * task) = 0;
+	//! Frees what prepare() allocated
+	virtual void release(InstallTask * task) = 0;
+
+	//! Starts installing a prepared task in the background
+	virtual int start(InstallTask * task) = 0;
+	virtual bool isCompleted() = 0;
+	//! Error code reported by the install, 0 on success
+	virtual u32 getInstallError() = 0;
+	//! Called after every start(), successful or not
+	virtual void finish() = 0;
+
+	//! Free bytes on the NAND or USB target, false if it can not be queried
+	virtual bool getFreeSpace(int target, u64 & freeBytes) = 0;
+
+	static bool isInstallableTitle(u32 titleIdHigh, u32 titleIdLow, bool & spoofFiles);
+
+	enum InstallResult
+	{
+		INSTALL_OK = 0,
+		ERROR_MCP_OPEN = -1,
+		ERROR_ALLOC = -2,
+		ERROR_INSTALL_INFO = -3,
+		ERROR_TITLE_TYPE = -4,
+		ERROR_TARGET_DEVICE = -5,
+		ERROR_TARGET_USB = -6,
+		ERROR_INSTALL_START = -7,
+		//! the install was started but MCP reported installError
+		ERROR_USB_CONNECTION = -8,
+		ERROR_INSTALL_FAILED = -9,
+		ERROR_CONTENT_VERIFY = -10,
+		ERROR_ALREADY_INSTALLED = -11
+	};
+
+	enum
+	{
+		NAND,
+		USB
+	};
+};
+
+#endif
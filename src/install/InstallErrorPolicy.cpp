@@ -0,0 +1,79 @@
+#include "InstallErrorPolicy.h"
+#include "InstallBackend.h"
+
+InstallErrorPolicy::InstallErrorPolicy()
+	: maxRetries(3)
+	, retryDelay(5000)
+	, maxRetryDelay(60000)
+{
+	//! an unattended batch keeps going no matter what fails
+	actions[ERROR_CLASS_NONE] = ACTION_CONTINUE;
+	actions[ERROR_CLASS_TRANSIENT] = ACTION_SKIP;
+	actions[ERROR_CLASS_CONTENT] = ACTION_SKIP;
+	actions[ERROR_CLASS_SPACE] = ACTION_SKIP;
+	actions[ERROR_CLASS_PERMISSION] = ACTION_SKIP;
+}
+
+int InstallErrorPolicy::classify(int result, u32 installError)
+{
+	switch(result)
+	{
+		case InstallBackend::ERROR_MCP_OPEN:
+		case InstallBackend::ERROR_ALLOC:
+		case InstallBackend::ERROR_TARGET_DEVICE:
+		case InstallBackend::ERROR_TARGET_USB:
+		case InstallBackend::ERROR_INSTALL_START:
+		case InstallBackend::ERROR_USB_CONNECTION:
+			return ERROR_CLASS_TRANSIENT;
+
+		case InstallBackend::ERROR_INSTALL_INFO:
+		case InstallBackend::ERROR_TITLE_TYPE:
+		case InstallBackend::ERROR_CONTENT_VERIFY:
+			return ERROR_CLASS_CONTENT;
+
+		case InstallBackend::ERROR_INSTALL_FAILED:
+			break;
+
+		default:
+			return (result >= 0) ? ERROR_CLASS_NONE : ERROR_CLASS_CONTENT;
+	}
+
+	if(installError == 0xFFFCFFE9 || installError == 0xFFFFF825)
+		return ERROR_CLASS_TRANSIENT;           // no connection, sd card read
+	if(installError == 0xFFFCFFE4)
+		return ERROR_CLASS_SPACE;
+	if(installError == 0xFFFBF446 || installError == 0xFFFBF43F || installError == 0xFFFBF441)
+		return ERROR_CLASS_CONTENT;             // title.tik
+	if((installError & 0xFFFF0000) == 0xFFFB0000)
+		return ERROR_CLASS_PERMISSION;
+
+	//! unknown errors are not retried, they would most likely come back
+	return ERROR_CLASS_CONTENT;
+}
+
+int InstallErrorPolicy::decide(int errorClass, int attempt) const
+{
+	if(errorClass < 0 || errorClass >= ERROR_CLASS_COUNT)
+		errorClass = ERROR_CLASS_CONTENT;
+
+	if(errorClass == ERROR_CLASS_TRANSIENT && attempt <= maxRetries)
+		return ACTION_RETRY;
+
+	return actions[errorClass];
+}
+
+u32 InstallErrorPolicy::getRetryDelay(int attempt) const
+{
+	u32 delay = retryDelay;
+
+	for(int i = 1; i < attempt && delay < maxRetryDelay; i++)
+		delay *= 2;
+
+	return (delay > maxRetryDelay) ? maxRetryDelay : delay;
+}
+
+void InstallErrorPolicy::setAction(int errorClass, int action)
+{
+	if(errorClass > ERROR_CLASS_NONE && errorClass < ERROR_CLASS_COUNT && action != ACTION_RETRY)
+		actions[errorClass] = action;
+}
@@ -0,0 +1,59 @@
+#ifndef INSTALL_ERROR_POLICY_H_
+#define INSTALL_ERROR_POLICY_H_
+
+#include "common/types.h"
+
+//! Decides what happens to a batch when a title fails.
+//! Transient errors are retried with a growing delay, everything else
+//! and transient errors that keep coming back skip the title.
+//! Does not depend on the OS so it can be fed made up error codes.
+class InstallErrorPolicy
+{
+public:
+	enum ErrorClass
+	{
+		ERROR_CLASS_NONE,
+		//! sd card, usb connection, IOS resources
+		ERROR_CLASS_TRANSIENT,
+		//! broken or incomplete WUP
+		ERROR_CLASS_CONTENT,
+		ERROR_CLASS_SPACE,
+		//! missing sig patches
+		ERROR_CLASS_PERMISSION,
+		ERROR_CLASS_COUNT
+	};
+
+	enum Action
+	{
+		ACTION_CONTINUE,
+		ACTION_RETRY,
+		ACTION_SKIP,
+		ACTION_ABORT
+	};
+
+	InstallErrorPolicy();
+
+	//! result is an InstallBackend::InstallResult, installError the MCP error
+	//! of an install that failed after it was started
+	static int classify(int result, u32 installError);
+
+	//! attempt counts the failures of the title so far, starting with 1
+	int decide(int errorClass, int attempt) const;
+	//! milliseconds to wait before the retry after failure attempt
+	u32 getRetryDelay(int attempt) const;
+
+	void setMaxRetries(int retries) { maxRetries = retries; }
+	int getMaxRetries() const { return maxRetries; }
+	//! the delay doubles with every retry up to maxDelay
+	void setRetryDelay(u32 delay, u32 maxDelay) { retryDelay = delay; maxRetryDelay = maxDelay; }
+	//! what to do with a class once it is not retried (anymore)
+	void setAction(int errorClass, int action);
+
+private:
+	int maxRetries;
+	u32 retryDelay;
+	u32 maxRetryDelay;
+	int actions[ERROR_CLASS_COUNT];
+};
+
+#endif
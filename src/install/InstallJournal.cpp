@@ -0,0 +1,160 @@
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "InstallJournal.h"
+#include "fs/fs_utils.h"
+#include "utils/StringTools.h"
+
+InstallJournal::InstallJournal(const std::string & journalPath)
+	: path(journalPath)
+	, fd(-1)
+{
+}
+
+InstallJournal::~InstallJournal()
+{
+	if(fd >= 0)
+		::close(fd);
+}
+
+bool InstallJournal::append(const std::string & line)
+{
+	if(fd < 0)
+		return false;
+
+	if(::write(fd, line.c_str(), line.size()) != (int)line.size())
+		return false;
+
+	//! the line has to be on the card before the next step starts
+	::fsync(fd);
+	return true;
+}
+
+bool InstallJournal::begin(const std::vector<std::string> & paths)
+{
+	if(fd >= 0)
+		::close(fd);
+
+	fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if(fd < 0)
+		return false;
+
+	//! the queued titles are written at once, the journal only counts once they are all there
+	std::string lines = strfmt("B %u\n", (u32)paths.size());
+	for(u32 i = 0; i < paths.size(); i++)
+		lines += strfmt("Q %u %s\n", i, paths[i].c_str());
+
+	return append(lines);
+}
+
+void InstallJournal::started(int pos)
+{
+	append(strfmt("S %i\n", pos));
+}
+
+void InstallJournal::completed(int pos)
+{
+	append(strfmt("C %i\n", pos));
+}
+
+void InstallJournal::failed(int pos, int error)
+{
+	append(strfmt("F %i %i\n", pos, error));
+}
+
+void InstallJournal::end()
+{
+	append("E\n");
+
+	::close(fd);
+	fd = -1;
+}
+
+void InstallJournal::discard()
+{
+	if(fd >= 0)
+		::close(fd);
+	fd = -1;
+
+	::unlink(path.c_str());
+}
+
+bool InstallJournal::load(std::vector<std::string> & pending)
+{
+	pending.clear();
+
+	u8 * data = NULL;
+	u32 size = 0;
+
+	if(LoadFileToMem(path.c_str(), &data, &size) < 0 || !data)
+		return false;
+
+	std::vector<std::string> paths;
+	std::vector<int> states;
+	bool ended = false;
+	u32 count = 0;
+
+	char * pos = (char *) data;
+	char * dataEnd = pos + size;
+
+	while(pos < dataEnd && !ended)
+	{
+		char * lineEnd = (char *) memchr(pos, '\n', dataEnd - pos);
+
+		//! a line without its newline was torn by a power loss
+		if(!lineEnd)
+			break;
+
+		*lineEnd = 0;
+
+		char type = pos[0];
+		char * arg = (pos[1] == ' ') ? pos + 2 : pos + 1;
+
+		if(type == 'B')
+		{
+			count = strtoul(arg, NULL, 10);
+			paths.clear();
+			states.clear();
+		}
+		else if(type == 'Q')
+		{
+			char * name = NULL;
+			u32 n = strtoul(arg, &name, 10);
+
+			if(n == paths.size() && name && *name == ' ')
+			{
+				paths.push_back(name + 1);
+				states.push_back(STATE_QUEUED);
+			}
+		}
+		else if(type == 'S' || type == 'C' || type == 'F')
+		{
+			u32 n = strtoul(arg, NULL, 10);
+
+			if(n < states.size())
+				states[n] = (type == 'S') ? STATE_STARTED : ((type == 'C') ? STATE_COMPLETED : STATE_FAILED);
+		}
+		else if(type == 'E')
+		{
+			ended = true;
+		}
+
+		pos = lineEnd + 1;
+	}
+
+	free(data);
+
+	//! a batch is only resumable once every queued title made it to the card
+	if(ended || paths.empty() || paths.size() != count)
+		return false;
+
+	for(u32 i = 0; i < paths.size(); i++)
+	{
+		if(states[i] == STATE_QUEUED || states[i] == STATE_STARTED)
+			pending.push_back(paths[i]);
+	}
+
+	return !pending.empty();
+}
@@ -0,0 +1,55 @@
+#ifndef INSTALL_JOURNAL_H_
+#define INSTALL_JOURNAL_H_
+
+#include <vector>
+#include <string>
+#include "common/types.h"
+
+#define INSTALL_JOURNAL_PATH    "fs:/vol/external01/wiiu/install_journal.txt"
+
+//! Append-only record of a running batch on the sd card.
+//! Every state change is one line that is flushed before the install
+//! continues, a line torn by a power loss is ignored when reading.
+//!
+//!   B <count>          batch started
+//!   Q <pos> <path>     title queued at position pos
+//!   S <pos>            install started
+//!   C <pos>            install completed
+//!   F <pos> <error>    install failed or skipped
+//!   E                  batch ended, nothing to resume
+class InstallJournal
+{
+public:
+	InstallJournal(const std::string & path = INSTALL_JOURNAL_PATH);
+	virtual ~InstallJournal();
+
+	//! Starts a new journal with the titles in install order
+	bool begin(const std::vector<std::string> & paths);
+	void started(int pos);
+	void completed(int pos);
+	void failed(int pos, int error);
+	void end();
+
+	//! Reads a journal of an interrupted batch, pending gets the titles that
+	//! were neither completed nor failed in install order.
+	//! Returns false if there is nothing to resume.
+	bool load(std::vector<std::string> & pending);
+	//! Deletes the journal
+	void discard();
+
+private:
+	bool append(const std::string & line);
+
+	enum
+	{
+		STATE_QUEUED,
+		STATE_STARTED,
+		STATE_COMPLETED,
+		STATE_FAILED
+	};
+
+	std::string path;
+	int fd;
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include "InstallQueue.h"
+#include "TitleIndex.h"
+#include "utils/logger.h"
+
+InstallQueue::InstallQueue(CFolderList * list, InstallBackend * installBackend, int target, int orderPolicy)
+	: CThread(CThread::eAttributeAffCore2 | CThread::eAttributePinnedAff)
+	, backend(installBackend)
+	, currentTask(-1)
+	, stopRequested(false)
+	, verifyContents(false)
+	, installerWaiting(true)
+{
+	std::vector<int> clicked = list->GetSelectedList();
+	std::vector<InstallScheduler::Entry> entries;
+
+	for(u32 i = 0; i < clicked.size(); i++)
+	{
+		const TitleManifest & manifest = list->GetManifest(clicked[i]);
+
+		InstallScheduler::Entry entry;
+		entry.index = clicked[i];
+		entry.titleIdHigh = manifest.getTitleIdHigh();
+		entry.titleIdLow = manifest.getTitleIdLow();
+		entry.size = manifest.getTotalSize();
+		entries.push_back(entry);
+	}
+
+	std::vector<int> selected = InstallScheduler::order(entries, orderPolicy);
+
+	for(u32 i = 0; i < selected.size(); i++)
+	{
+		InstallTask * task = new InstallTask;
+		task->index = selected[i];
+		task->name = list->GetName(selected[i]);
+		task->path = list->GetPath(selected[i]);
+		task->installFolder = task->path;
+		task->target = target;
+		task->manifest = list->GetManifest(selected[i]);
+		task->titleIdHigh = task->manifest.getTitleIdHigh();
+		task->titleIdLow = task->manifest.getTitleIdLow();
+		task->result = InstallBackend::INSTALL_OK;
+		task->prepared = false;
+		task->backendData = NULL;
+		task->failedContent = 0;
+		task->failedOffset = 0;
+		task->installError = 0;
+		task->lastError = 0;
+		task->retries = 0;
+		task->verifyStart = 0;
+		task->verifyEnd = 0;
+		task->prepareStart = 0;
+		task->prepareEnd = 0;
+		task->waitStart = 0;
+		task->installStart = 0;
+		task->installEnd = 0;
+
+		tasks.push_back(task);
+	}
+}
+
+InstallQueue::~InstallQueue()
+{
+	stop();
+	shutdownThread();
+
+	for(u32 i = 0; i < tasks.size(); i++)
+	{
+		backend->release(tasks[i]);
+		delete tasks[i];
+	}
+
+	tasks.clear();
+}
+
+void InstallQueue::stop()
+{
+	stopRequested = true;
+	verifier.abort();
+	consumedEvent.signal();
+	preparedEvent.signal();
+}
+
+InstallTask * InstallQueue::next()
+{
+	queueMutex.lock();
+	int pos = ++currentTask;
+	queueMutex.unlock();
+
+	//! let the worker continue with the title after this one
+	consumedEvent.signal();
+
+	if(pos >= (int) tasks.size())
+		return NULL;
+
+	InstallTask * task = tasks[pos];
+	task->waitStart = OSGetTime();
+
+	//! nothing installs while we wait, so the verification can run at full speed
+	installerWaiting = true;
+	verifier.setBandwidthLimit(0);
+
+	while(!stopRequested)
+	{
+		queueMutex.lock();
+		bool prepared = task->prepared;
+		queueMutex.unlock();
+
+		if(prepared)
+			break;
+
+		preparedEvent.wait();
+	}
+
+	installerWaiting = false;
+	verifier.setBandwidthLimit(VERIFY_BANDWIDTH_LIMIT);
+
+	if(stopRequested)
+		return NULL;
+
+	return task;
+}
+
+void InstallQueue::finish(InstallTask * task)
+{
+	if(!task)
+		return;
+
+	queueMutex.lock();
+	backend->release(task);
+	queueMutex.unlock();
+}
+
+int InstallQueue::retry(InstallTask * task)
+{
+	//! the worker may be preparing the next title with the same backend
+	prepareMutex.lock();
+
+	backend->release(task);
+	int result = backend->prepare(task);
+	if(result != InstallBackend::INSTALL_OK)
+		backend->release(task);
+
+	prepareMutex.unlock();
+
+	queueMutex.lock();
+	task->result = result;
+	queueMutex.unlock();
+
+	return result;
+}
+
+void InstallQueue::executeThread()
+{
+	for(u32 i = 0; i < tasks.size() && !stopRequested; i++)
+	{
+		//! do not run further ahead of the installer than needed
+		while(!stopRequested)
+		{
+			queueMutex.lock();
+			bool ahead = ((int)i > currentTask + PrepareAhead);
+			queueMutex.unlock();
+
+			if(!ahead)
+				break;
+
+			consumedEvent.wait();
+		}
+
+		if(stopRequested)
+			break;
+
+		prepareTask(tasks[i]);
+		preparedEvent.signal();
+	}
+}
+
+int InstallQueue::verifyTask(InstallTask * task)
+{
+	task->verifyStart = OSGetTime();
+
+	//! keep core 0 and most of the SD bandwidth to a running install
+	if(installerWaiting)
+	{
+		verifier.setThreadCount(VERIFY_THREAD_COUNT);
+		verifier.setBandwidthLimit(0);
+	}
+	else
+	{
+		verifier.setThreadCount(2);
+		verifier.setBandwidthLimit(VERIFY_BANDWIDTH_LIMIT);
+	}
+
+	int result = InstallBackend::INSTALL_OK;
+	int verifyResult = verifier.verify(task->path, task->manifest);
+
+	if(verifyResult != ContentVerifier::VERIFY_OK && verifyResult != ContentVerifier::VERIFY_ERROR_ABORTED)
+	{
+		log_printf("InstallQueue: %s content %08X failed verification (%i) at 0x%llX\n", task->name.c_str(), verifier.getFailedContent(), verifyResult, verifier.getFailedOffset());
+		task->failedContent = verifier.getFailedContent();
+		task->failedOffset = verifier.getFailedOffset();
+		result = InstallBackend::ERROR_CONTENT_VERIFY;
+	}
+
+	task->verifyEnd = OSGetTime();
+
+	return result;
+}
+
+void InstallQueue::prepareTask(InstallTask * task)
+{
+	int result = InstallBackend::INSTALL_OK;
+
+	//! nothing to do if the same or a newer version is on the target
+	if(task->manifest.isValid() && TitleIndex::instance()->isInstalled(task->manifest.getTitleId(), task->manifest.getVersion(), task->target))
+	{
+		log_printf("InstallQueue: %s v%u is already installed\n", task->name.c_str(), task->manifest.getVersion());
+		result = InstallBackend::ERROR_ALREADY_INSTALLED;
+	}
+
+	//! a title with bad contents is skipped before MCP is touched
+	if(result == InstallBackend::INSTALL_OK && verifyContents && task->manifest.isValid())
+		result = verifyTask(task);
+
+	task->prepareStart = OSGetTime();
+
+	if(result == InstallBackend::INSTALL_OK)
+	{
+		prepareMutex.lock();
+		result = backend->prepare(task);
+		prepareMutex.unlock();
+	}
+
+	//! nothing is left to install for a failed title
+	if(result != InstallBackend::INSTALL_OK)
+		backend->release(task);
+
+	queueMutex.lock();
+	task->result = result;
+	task->prepareEnd = OSGetTime();
+	task->prepared = true;
+	queueMutex.unlock();
+}
+
+void InstallQueue::logTimings()
+{
+	u32 verifyMs = 0;
+	u32 prepareMs = 0;
+	u32 waitMs = 0;
+	u32 installMs = 0;
+	u32 gapMs = 0;
+	OSTime batchEnd = 0;
+
+	for(u32 i = 0; i < tasks.size(); i++)
+	{
+		InstallTask * task = tasks[i];
+		if(!task->installStart && !task->verifyEnd)
+			continue;
+
+		u32 verify = task->verifyEnd ? OSTicksToMilliseconds(task->verifyEnd - task->verifyStart) : 0;
+		u32 prepare = OSTicksToMilliseconds(task->prepareEnd - task->prepareStart);
+		u32 wait = (task->prepareEnd > task->waitStart) ? OSTicksToMilliseconds(task->prepareEnd - task->waitStart) : 0;
+		u32 install = task->installEnd ? OSTicksToMilliseconds(task->installEnd - task->installStart) : 0;
+		u32 gap = (i > 0 && tasks[i-1]->installEnd && task->installStart) ? OSTicksToMilliseconds(task->installStart - tasks[i-1]->installEnd) : 0;
+
+		log_printf("InstallQueue: %s verify %u ms, prepare %u ms, wait %u ms, install %u ms, gap %u ms\n", task->name.c_str(), verify, prepare, wait, install, gap);
+
+		verifyMs += verify;
+		prepareMs += prepare;
+		waitMs += wait;
+		installMs += install;
+		gapMs += gap;
+
+		if(task->installEnd > batchEnd)
+			batchEnd = task->installEnd;
+		if(task->prepareEnd > batchEnd)
+			batchEnd = task->prepareEnd;
+	}
+
+	log_printf("InstallQueue: total verify %u ms, prepare %u ms, wait %u ms, install %u ms, gap %u ms\n", verifyMs, prepareMs, waitMs, installMs, gapMs);
+
+	//! with the verification overlapping the installs this gets close to max(verify, install)
+	if(!tasks.empty() && tasks[0]->waitStart && batchEnd)
+		log_printf("InstallQueue: batch took %u ms\n", (u32)OSTicksToMilliseconds(batchEnd - tasks[0]->waitStart));
+}
@@ -0,0 +1,70 @@
+#ifndef INSTALL_QUEUE_H_
+#define INSTALL_QUEUE_H_
+
+#include <vector>
+#include <string>
+#include "fs/CFolderList.hpp"
+#include "InstallBackend.h"
+#include "ContentVerifier.h"
+#include "InstallScheduler.h"
+#include "system/CThread.h"
+#include "system/CMutex.h"
+#include "system/CEvent.h"
+
+class InstallQueue : public CThread
+{
+public:
+	//! the selected titles are ordered base game, update, DLC, the groups by orderPolicy
+	InstallQueue(CFolderList * list, InstallBackend * backend, int target, int orderPolicy = InstallScheduler::POLICY_CLICK_ORDER);
+	virtual ~InstallQueue();
+
+	void start()
+	{
+		resumeThread();
+	}
+
+	//! Blocks until the next title is prepared, returns NULL at the end of the queue
+	InstallTask * next();
+	//! Releases what the backend prepared for a task once its install is done
+	void finish(InstallTask * task);
+	//! Prepares a task that failed to prepare once more, called from the install thread
+	int retry(InstallTask * task);
+	//! Stops the worker and wakes up anyone waiting in next()
+	void stop();
+
+	int getCount() const { return tasks.size(); }
+	//! tasks in install order
+	InstallTask * getTask(int pos) const { return tasks[pos]; }
+
+	//! Checks the contents of every title against its TMD before preparing it
+	void setVerify(bool enable) { verifyContents = enable; }
+
+	//! Prints the per stage timings of the processed titles to the log
+	void logTimings();
+
+private:
+	void executeThread();
+	void prepareTask(InstallTask * task);
+	int verifyTask(InstallTask * task);
+
+	//! how many titles the worker may prepare in front of the installing one
+	static const int PrepareAhead = 1;
+
+	InstallBackend * backend;
+	std::vector<InstallTask *> tasks;
+	int currentTask;
+
+	volatile bool stopRequested;
+	bool verifyContents;
+	//! the installer is blocked in next(), verification may use every core
+	volatile bool installerWaiting;
+	ContentVerifier verifier;
+
+	CMutex queueMutex;
+	//! serializes backend->prepare() between the worker and retry()
+	CMutex prepareMutex;
+	CEvent preparedEvent;
+	CEvent consumedEvent;
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include <map>
+#include <algorithm>
+#include "InstallScheduler.h"
+
+namespace
+{
+
+typedef struct
+{
+	u32 titleIdLow;
+	int firstClick;
+	u64 size;
+	//! positions in the entry list
+	std::vector<int> members;
+} Group;
+
+//! orders the titles of a group by type and then by click order
+class CompareMembers
+{
+public:
+	CompareMembers(const std::vector<InstallScheduler::Entry> & list) : entries(list) {}
+
+	bool operator()(int a, int b) const
+	{
+		int rankA = InstallScheduler::getTypeRank(entries[a].titleIdHigh);
+		int rankB = InstallScheduler::getTypeRank(entries[b].titleIdHigh);
+
+		if(rankA != rankB)
+			return rankA < rankB;
+
+		return a < b;
+	}
+
+private:
+	const std::vector<InstallScheduler::Entry> & entries;
+};
+
+bool CompareClickOrder(const Group & a, const Group & b)
+{
+	return a.firstClick < b.firstClick;
+}
+
+bool CompareSmallest(const Group & a, const Group & b)
+{
+	if(a.size != b.size)
+		return a.size < b.size;
+
+	return a.firstClick < b.firstClick;
+}
+
+bool CompareLargest(const Group & a, const Group & b)
+{
+	if(a.size != b.size)
+		return a.size > b.size;
+
+	return a.firstClick < b.firstClick;
+}
+
+}
+
+int InstallScheduler::getTypeRank(u32 titleIdHigh)
+{
+	switch(titleIdHigh)
+	{
+		case 0x00050000: return 0;  // game
+		case 0x0005000E: return 1;  // game update
+		case 0x0005000C: return 2;  // DLC
+		default: return 3;
+	}
+}
+
+std::vector<int> InstallScheduler::order(const std::vector<Entry> & entries, int policy)
+{
+	std::vector<Group> groups;
+	std::map<u32, int> groupIndex;
+
+	for(u32 i = 0; i < entries.size(); i++)
+	{
+		int group;
+
+		//! titles without a title id can not depend on anything, they stay on their own
+		if(entries[i].titleIdHigh == 0 && entries[i].titleIdLow == 0)
+		{
+			group = -1;
+		}
+		else
+		{
+			std::map<u32, int>::iterator itr = groupIndex.find(entries[i].titleIdLow);
+			group = (itr != groupIndex.end()) ? itr->second : -1;
+		}
+
+		if(group < 0)
+		{
+			Group newGroup;
+			newGroup.titleIdLow = entries[i].titleIdLow;
+			newGroup.firstClick = i;
+			newGroup.size = 0;
+			group = groups.size();
+			groups.push_back(newGroup);
+
+			if(entries[i].titleIdHigh != 0 || entries[i].titleIdLow != 0)
+				groupIndex[entries[i].titleIdLow] = group;
+		}
+
+		groups[group].members.push_back(i);
+		groups[group].size += entries[i].size;
+	}
+
+	for(u32 i = 0; i < groups.size(); i++)
+		std::sort(groups[i].members.begin(), groups[i].members.end(), CompareMembers(entries));
+
+	if(policy == POLICY_SMALLEST_FIRST)
+		std::stable_sort(groups.begin(), groups.end(), CompareSmallest);
+	else if(policy == POLICY_LARGEST_FIRST)
+		std::stable_sort(groups.begin(), groups.end(), CompareLargest);
+	else
+		std::stable_sort(groups.begin(), groups.end(), CompareClickOrder);
+
+	std::vector<int> result;
+	for(u32 i = 0; i < groups.size(); i++)
+	{
+		for(u32 n = 0; n < groups[i].members.size(); n++)
+			result.push_back(entries[groups[i].members[n]].index);
+	}
+
+	return result;
+}
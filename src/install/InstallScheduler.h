@@ -0,0 +1,39 @@
+#ifndef INSTALL_SCHEDULER_H_
+#define INSTALL_SCHEDULER_H_
+
+#include <vector>
+#include "common/types.h"
+
+//! Orders a batch so a game is installed before its update and its DLC.
+//! Titles are grouped by the low word of the title id, the groups are
+//! ordered by the policy.
+class InstallScheduler
+{
+public:
+	typedef struct
+	{
+		//! whatever the caller uses to identify the title
+		int index;
+		u32 titleIdHigh;
+		u32 titleIdLow;
+		u64 size;
+	} Entry;
+
+	enum Policy
+	{
+		//! groups in the order their first title was selected
+		POLICY_CLICK_ORDER,
+		//! smallest groups first, the first titles are done quickly
+		POLICY_SMALLEST_FIRST,
+		//! largest groups first, for unattended runs
+		POLICY_LARGEST_FIRST
+	};
+
+	//! entries are expected in click order, returns their indices in install order
+	static std::vector<int> order(const std::vector<Entry> & entries, int policy);
+
+	//! base game, update, DLC and then everything else
+	static int getTypeRank(u32 titleIdHigh);
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "InstallStatsLog.h"
+#include "utils/StringTools.h"
+
+InstallStatsLog::InstallStatsLog(const std::string & path)
+	: batchTime((u32)(OSTicksToMilliseconds(OSGetTime()) / 1000) + EpochOffset)
+	, writer(path)
+{
+}
+
+std::string InstallStatsLog::escape(const std::string & text)
+{
+	std::string result;
+
+	for(u32 i = 0; i < text.size(); i++)
+	{
+		unsigned char c = text[i];
+
+		if(c == '"' || c == '\\')
+		{
+			result += '\\';
+			result += c;
+		}
+		else if(c < 0x20)
+		{
+			result += strfmt("\\u%04x", c);
+		}
+		else
+		{
+			result += c;
+		}
+	}
+
+	return result;
+}
+
+void InstallStatsLog::record(const InstallTask * task, int result, const ProgressSampler * sampler)
+{
+	u32 now = (u32)(OSTicksToMilliseconds(OSGetTime()) / 1000) + EpochOffset;
+
+	std::string line = strfmt("{\"batch\":%u,\"time\":%u,\"name\":\"%s\",\"title_id\":\"%016llX\",\"version\":%u,\"target\":\"%s\"",
+	                          batchTime, now, escape(task->name).c_str(), task->manifest.getTitleId(), task->manifest.getVersion(),
+	                          (task->target == InstallBackend::USB) ? "usb" : "nand");
+
+	line += strfmt(",\"result\":%i,\"install_error\":\"0x%08X\",\"attempt\":%i", result, task->installError, task->retries + 1);
+	line += strfmt(",\"verify_ms\":%u,\"prepare_ms\":%u,\"wait_ms\":%u,\"install_ms\":%u",
+	               toMs(task->verifyStart, task->verifyEnd), toMs(task->prepareStart, task->prepareEnd),
+	               toMs(task->waitStart, task->prepareEnd), sampler ? toMs(task->installStart, task->installEnd) : 0);
+
+	if(sampler)
+	{
+		line += strfmt(",\"bytes\":%llu,\"total_bytes\":%llu,\"avg_mibps\":%0.2f,\"peak_mibps\":%0.2f,\"histogram\":[",
+		               sampler->getInstalledSize(), sampler->getTotalSize(), sampler->getAverageThroughput(), sampler->getPeakThroughput());
+
+		const u32 * histogram = sampler->getHistogram();
+		for(int i = 0; i < ProgressSampler::HistogramBuckets; i++)
+			line += strfmt((i == 0) ? "%u" : ",%u", histogram[i]);
+
+		line += "]";
+	}
+
+	line += "}\n";
+
+	//! a title takes minutes, writing every line right away costs nothing
+	writer.write(line);
+	writer.flush();
+}
@@ -0,0 +1,33 @@
+#ifndef INSTALL_STATS_LOG_H_
+#define INSTALL_STATS_LOG_H_
+
+#include <string>
+#include "fs/BufferedWriter.h"
+#include "InstallBackend.h"
+#include "ProgressSampler.h"
+
+#define INSTALL_STATS_PATH      "fs:/vol/external01/wiiu/install_stats.jsonl"
+
+//! Writes one JSON line per install attempt so the throughput of cards,
+//! targets and titles can be compared later
+class InstallStatsLog
+{
+public:
+	InstallStatsLog(const std::string & path = INSTALL_STATS_PATH);
+	virtual ~InstallStatsLog() {}
+
+	//! sampler is NULL for attempts that never reached MCP
+	void record(const InstallTask * task, int result, const ProgressSampler * sampler);
+
+private:
+	static std::string escape(const std::string & text);
+	static u32 toMs(OSTime start, OSTime end) { return (start && end > start) ? (u32)OSTicksToMilliseconds(end - start) : 0; }
+
+	//! seconds between the console epoch 2000-01-01 and the unix epoch
+	static const u32 EpochOffset = 946684800;
+
+	u32 batchTime;
+	BufferedWriter writer;
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include <string.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <coreinit/mcp.h>
+#include <coreinit/memory.h>
+#include <coreinit/filesystem.h>
+#include "McpInstallBackend.h"
+#include "utils/logger.h"
+
+extern "C" MCPError MCP_GetLastRawError(void);
+
+McpInstallBackend::McpInstallBackend()
+	: prepareHandle(-1)
+	, installHandle(-1)
+	, progressInfo(NULL)
+	, installCompleted(false)
+	, installError(0)
+{
+}
+
+McpInstallBackend::~McpInstallBackend()
+{
+	finish();
+
+	if(prepareHandle > 0)
+		MCP_Close(prepareHandle);
+}
+
+void McpInstallBackend::IosInstallCallback(IOSError errorCode, void * priv_data)
+{
+	McpInstallBackend * backend = (McpInstallBackend *) priv_data;
+
+	backend->installError = errorCode;
+	backend->installCompleted = true;
+}
+
+int McpInstallBackend::prepare(InstallTask * task)
+{
+	//!---------------------------------------------------
+	//! This part of code originates from Crediars MCP patcher assembly code
+	//! it is just translated to C
+	//!---------------------------------------------------
+	if(prepareHandle <= 0)
+		prepareHandle = MCP_Open();
+
+	if(prepareHandle <= 0)
+		return ERROR_MCP_OPEN;
+
+	McpTaskData * data = new McpTaskData;
+	data->mcpInstallInfo = (u32 *)OSAllocFromSystem(0x24, 0x40);
+	data->mcpInstallPath = (char *)OSAllocFromSystem(MAX_INSTALL_PATH_LENGTH, 0x40);
+	data->mcpPathInfoVector = (IOSVec *)OSAllocFromSystem(0x0C, 0x40);
+	task->backendData = data;
+
+	if(!data->mcpInstallInfo || !data->mcpInstallPath || !data->mcpPathInfoVector)
+		return ERROR_ALLOC;
+
+	task->installFolder = task->path;
+	task->installFolder.erase(0, 19);
+	task->installFolder.insert(0, "/vol/app_sd/");
+
+	memset(data->mcpInstallPath, 0, MAX_INSTALL_PATH_LENGTH);
+	snprintf(data->mcpInstallPath, MAX_INSTALL_PATH_LENGTH, "%s", task->installFolder.c_str());
+
+	int res = MCP_InstallGetInfo(prepareHandle, data->mcpInstallPath, (MCPInstallInfo*)data->mcpInstallInfo);
+	if(res != 0)
+	{
+		task->lastError = MCP_GetLastRawError();
+		return ERROR_INSTALL_INFO;
+	}
+
+	task->titleIdHigh = data->mcpInstallInfo[0];
+	task->titleIdLow = data->mcpInstallInfo[1];
+
+	bool spoofFiles = false;
+	if(!isInstallableTitle(task->titleIdHigh, task->titleIdLow, spoofFiles))
+		return ERROR_TITLE_TYPE;
+
+	if(spoofFiles)
+		task->target = NAND;
+
+	data->mcpInstallInfo[2] = (unsigned int)MCP_COMMAND_INSTALL_ASYNC;
+	data->mcpInstallInfo[3] = (unsigned int)data->mcpPathInfoVector;
+	data->mcpInstallInfo[4] = (unsigned int)1;
+	data->mcpInstallInfo[5] = (unsigned int)0;
+
+	memset(data->mcpPathInfoVector, 0, 0x0C);
+	data->mcpPathInfoVector->vaddr = data->mcpInstallPath;
+	data->mcpPathInfoVector->len = (unsigned int)MAX_INSTALL_PATH_LENGTH;
+
+	return INSTALL_OK;
+}
+
+void McpInstallBackend::release(InstallTask * task)
+{
+	McpTaskData * data = (McpTaskData *) task->backendData;
+	if(!data)
+		return;
+
+	if(data->mcpPathInfoVector)
+		OSFreeToSystem(data->mcpPathInfoVector);
+	if(data->mcpInstallPath)
+		OSFreeToSystem(data->mcpInstallPath);
+	if(data->mcpInstallInfo)
+		OSFreeToSystem(data->mcpInstallInfo);
+
+	delete data;
+	task->backendData = NULL;
+}
+
+int McpInstallBackend::start(InstallTask * task)
+{
+	McpTaskData * data = (McpTaskData *) task->backendData;
+
+	installCompleted = false;
+	installError = 0;
+
+	installHandle = MCP_Open();
+	if(installHandle <= 0)
+		return ERROR_MCP_OPEN;
+
+	int res = MCP_InstallSetTargetDevice(installHandle, (MCPInstallTarget)(task->target));
+	if(res != 0)
+	{
+		task->lastError = MCP_GetLastRawError();
+		return ERROR_TARGET_DEVICE;
+	}
+	res = MCP_InstallSetTargetUsb(installHandle, (MCPInstallTarget)(task->target));
+	if(res != 0)
+	{
+		task->lastError = MCP_GetLastRawError();
+		return ERROR_TARGET_USB;
+	}
+
+	//! the install info buffer doubles as output of the progress requests
+	progressInfo = data->mcpInstallInfo;
+
+	res = IOS_IoctlvAsync(installHandle, MCP_COMMAND_INSTALL_ASYNC, 1, 0, data->mcpPathInfoVector, (IOSAsyncCallbackFn)IosInstallCallback, this);
+	if(res != 0)
+	{
+		task->lastError = MCP_GetLastRawError();
+		progressInfo = NULL;
+		return ERROR_INSTALL_START;
+	}
+
+	return INSTALL_OK;
+}
+
+bool McpInstallBackend::getProgress(u64 & installedSize, u64 & totalSize)
+{
+	if(installHandle <= 0 || !progressInfo)
+		return false;
+
+	memset(progressInfo, 0, 0x24);
+
+	MCP_InstallGetProgress(installHandle, (MCPInstallProgress*)progressInfo);
+
+	if(progressInfo[0] != 1)
+		return false;
+
+	totalSize = ((u64)progressInfo[3] << 32ULL) | progressInfo[4];
+	installedSize = ((u64)progressInfo[5] << 32ULL) | progressInfo[6];
+	return true;
+}
+
+void McpInstallBackend::finish()
+{
+	if(installHandle > 0)
+		MCP_Close(installHandle);
+
+	installHandle = -1;
+	progressInfo = NULL;
+}
+
+bool McpInstallBackend::getFreeSpace(int target, u64 & freeBytes)
+{
+	FSClient * client = (FSClient *) malloc(sizeof(FSClient));
+	FSCmdBlock * cmd = (FSCmdBlock *) malloc(sizeof(FSCmdBlock));
+
+	if(!client || !cmd)
+	{
+		log_printf("McpInstallBackend: no memory for the free space query\n");
+		free(client);
+		free(cmd);
+		return false;
+	}
+
+	FSInit();
+
+	FSStatus status = FSAddClient(client, FS_ERROR_FLAG_ALL);
+	if(status != FS_STATUS_OK)
+	{
+		log_printf("McpInstallBackend: FSAddClient failed %i\n", status);
+		free(client);
+		free(cmd);
+		return false;
+	}
+
+	FSInitCmdBlock(cmd);
+
+	u64 size = 0;
+	const char * path = (target == USB) ? USB_STORAGE_PATH : NAND_STORAGE_PATH;
+
+	status = FSGetFreeSpaceSize(client, cmd, path, &size, FS_ERROR_FLAG_ALL);
+	if(status == FS_STATUS_OK)
+		freeBytes = size;
+	else
+		log_printf("McpInstallBackend: FSGetFreeSpaceSize of %s failed %i\n", path, status);
+
+	FSDelClient(client, FS_ERROR_FLAG_ALL);
+	free(client);
+	free(cmd);
+
+	return (status == FS_STATUS_OK);
+}
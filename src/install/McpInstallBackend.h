@@ -0,0 +1,51 @@
+#ifndef MCP_INSTALL_BACKEND_H_
+#define MCP_INSTALL_BACKEND_H_
+
+#include <coreinit/ios.h>
+#include "InstallBackend.h"
+
+#define MCP_COMMAND_INSTALL_ASYNC   0x81
+#define MAX_INSTALL_PATH_LENGTH     0x27F
+
+#define NAND_STORAGE_PATH           "/vol/storage_mlc01"
+#define USB_STORAGE_PATH            "/vol/storage_usb01"
+
+//! Installs through the MCP resource of IOSU
+class McpInstallBackend : public InstallBackend
+{
+public:
+	McpInstallBackend();
+	virtual ~McpInstallBackend();
+
+	int prepare(InstallTask * task);
+	void release(InstallTask * task);
+
+	int start(InstallTask * task);
+	bool isCompleted() { return installCompleted; }
+	u32 getInstallError() { return installError; }
+	void finish();
+
+	bool getFreeSpace(int target, u64 & freeBytes);
+
+	bool getProgress(u64 & installedSize, u64 & totalSize);
+
+private:
+	static void IosInstallCallback(IOSError errorCode, void * priv_data);
+
+	//! MCP buffers, allocated from the system heap by prepare()
+	typedef struct
+	{
+		u32 * mcpInstallInfo;
+		char * mcpInstallPath;
+		IOSVec * mcpPathInfoVector;
+	} McpTaskData;
+
+	int prepareHandle;
+	int installHandle;
+	u32 * progressInfo;
+
+	volatile bool installCompleted;
+	volatile u32 installError;
+};
+
+#endif
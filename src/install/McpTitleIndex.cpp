@@ -0,0 +1,58 @@
+#include <malloc.h>
+#include <string.h>
+#include <coreinit/mcp.h>
+#include "McpTitleIndex.h"
+#include "InstallBackend.h"
+#include "utils/logger.h"
+
+bool McpTitleIndex::load()
+{
+	int handle = MCP_Open();
+	if(handle < 0)
+		return false;
+
+	int count = MCP_TitleCount(handle);
+	if(count <= 0)
+	{
+		MCP_Close(handle);
+		return false;
+	}
+
+	MCPTitleListType * list = (MCPTitleListType *) memalign(0x40, count * sizeof(MCPTitleListType));
+	if(!list)
+	{
+		MCP_Close(handle);
+		return false;
+	}
+
+	u32 listed = 0;
+	bool result = (MCP_TitleList(handle, &listed, list, count * sizeof(MCPTitleListType)) >= 0);
+
+	if(result)
+	{
+		int nandCount = 0;
+		int usbCount = 0;
+
+		for(u32 i = 0; i < listed; i++)
+		{
+			//! titles on an sd card or the disc drive can not be install targets
+			if(strncmp(list[i].indexedDevice, "mlc", 3) == 0)
+			{
+				insert(list[i].titleId, list[i].titleVersion, InstallBackend::NAND);
+				nandCount++;
+			}
+			else if(strncmp(list[i].indexedDevice, "usb", 3) == 0)
+			{
+				insert(list[i].titleId, list[i].titleVersion, InstallBackend::USB);
+				usbCount++;
+			}
+		}
+
+		log_printf("McpTitleIndex: %u titles, %i on NAND, %i on USB\n", listed, nandCount, usbCount);
+	}
+
+	free(list);
+	MCP_Close(handle);
+
+	return result;
+}
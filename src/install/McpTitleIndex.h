@@ -0,0 +1,16 @@
+#ifndef MCP_TITLE_INDEX_H_
+#define MCP_TITLE_INDEX_H_
+
+#include "TitleIndex.h"
+
+//! Reads the installed titles from the MCP title list
+class McpTitleIndex : public TitleIndex
+{
+public:
+	McpTitleIndex() {}
+
+protected:
+	bool load();
+};
+
+#endif
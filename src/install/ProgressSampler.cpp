@@ -0,0 +1,131 @@
+#include <math.h>
+#include "ProgressSampler.h"
+#include "utils/StringTools.h"
+
+//! time constant of the throughput average in milliseconds
+#define THROUGHPUT_TIME_CONSTANT    2000.0f
+
+const f32 ProgressSampler::BytesPerMsToMiBs = 1000.0f / (1024.0f * 1024.0f);
+
+ProgressSampler::ProgressSampler(ProgressSource * src)
+	: source(src)
+	, installedSize(0)
+	, totalSize(0)
+	, firstSampleMs(0)
+	, firstInstalled(0)
+	, lastSampleMs(0)
+	, throughput(0.0f)
+	, peakThroughput(0.0f)
+	, percent(-1)
+	, eta(0)
+	, interval(100)
+	, infoMs(0)
+{
+	for(int i = 0; i < HistogramBuckets; i++)
+		histogram[i] = 0;
+}
+
+f32 ProgressSampler::getAverageThroughput() const
+{
+	if(lastSampleMs <= firstSampleMs || installedSize < firstInstalled)
+		return 0.0f;
+
+	return (f32)(installedSize - firstInstalled) / (f32)(lastSampleMs - firstSampleMs) * BytesPerMsToMiBs;
+}
+
+int ProgressSampler::sample(u64 nowMs)
+{
+	u64 installed = 0;
+	u64 total = 0;
+
+	if(!source || !source->getProgress(installed, total))
+		return UNCHANGED;
+
+	if(lastSampleMs && nowMs > lastSampleMs && installed >= installedSize && total == totalSize)
+	{
+		f32 dt = (f32)(nowMs - lastSampleMs);
+		f32 current = (f32)(installed - installedSize) / dt;
+		f32 alpha = 1.0f - expf(-dt / THROUGHPUT_TIME_CONSTANT);
+
+		if(throughput <= 0.0f)
+			throughput = current;
+		else
+			throughput += alpha * (current - throughput);
+
+		if(throughput > peakThroughput)
+			peakThroughput = throughput;
+
+		int bucket = (int)(current * BytesPerMsToMiBs);
+		histogram[(bucket < HistogramBuckets) ? bucket : HistogramBuckets - 1]++;
+	}
+	else if(!lastSampleMs)
+	{
+		firstSampleMs = nowMs;
+		firstInstalled = installed;
+	}
+
+	installedSize = installed;
+	totalSize = total;
+	lastSampleMs = nowMs;
+
+	if(throughput > 0.0f && totalSize > installedSize)
+		eta = (u32)(((totalSize - installedSize) / throughput) / 1000.0f);
+	else
+		eta = 0;
+
+	updateInterval();
+
+	int result = UNCHANGED;
+
+	int newPercent = (totalSize != 0) ? (int)((installedSize * 100.0f) / totalSize) : 0;
+	if(newPercent != percent)
+	{
+		percent = newPercent;
+		result |= PERCENT_CHANGED;
+	}
+
+	//! sizes, speed and time left change with nearly every sample, a text that
+	//! changes that often can not be read and costs a new text layout each time.
+	//! Only a new percent step shows up right away, with the last speed.
+	bool refresh = !infoMs || nowMs >= infoMs + InfoInterval;
+
+	if(refresh)
+	{
+		u32 speed = (u32)(getThroughput() * 10.0f);
+		speedInfo = (speed > 0) ? strfmt("  %0.1f MiB/s  剩余 %u:%02u", speed / 10.0f, eta / 60, eta % 60) : "";
+		infoMs = nowMs;
+	}
+
+	if(refresh || result)
+	{
+		std::string newInfo = strfmt("%0.1f / %0.1f MiB (%i%%)", installedSize / (1024.0f * 1024.0f), totalSize / (1024.0f * 1024.0f), percent);
+		newInfo += speedInfo;
+
+		if(newInfo != info)
+		{
+			info.swap(newInfo);
+			result |= INFO_CHANGED;
+		}
+	}
+
+	return result;
+}
+
+void ProgressSampler::updateInterval()
+{
+	//! poll about every half percent of the title but stay in sane bounds
+	if(throughput <= 0.0f || totalSize == 0)
+	{
+		interval = 100;
+		return;
+	}
+
+	f32 step = (totalSize / 200.0f) / throughput;
+
+	if(step < MinInterval)
+		interval = MinInterval;
+	else if(step > MaxInterval)
+		interval = MaxInterval;
+	else
+		interval = (u32) step;
+}
@@ -0,0 +1,85 @@
+#ifndef PROGRESS_SAMPLER_H_
+#define PROGRESS_SAMPLER_H_
+
+#include <string>
+#include "common/types.h"
+
+//! Anything that can report how far an install is
+class ProgressSource
+{
+public:
+	virtual ~ProgressSource() {}
+
+	//! Returns false while no install progress is available
+	virtual bool getProgress(u64 & installedSize, u64 & totalSize) = 0;
+};
+
+//! Polls a ProgressSource, keeps an EWMA of the throughput and only reports
+//! a change when something that is shown on screen changed. Sizes and
+//! throughput are in MiB.
+class ProgressSampler
+{
+public:
+	ProgressSampler(ProgressSource * source);
+	virtual ~ProgressSampler() {}
+
+	enum SampleResult
+	{
+		UNCHANGED = 0x00,
+		PERCENT_CHANGED = 0x01,
+		INFO_CHANGED = 0x02
+	};
+
+	//! Polls the source, returns a combination of SampleResult flags
+	int sample(u64 nowMs);
+	//! Milliseconds until the next sample should be taken
+	u32 getInterval() const { return interval; }
+
+	int getPercent() const { return percent; }
+	u64 getInstalledSize() const { return installedSize; }
+	u64 getTotalSize() const { return totalSize; }
+	//! Smoothed throughput in MiB/s
+	f32 getThroughput() const { return throughput * BytesPerMsToMiBs; }
+	//! Highest smoothed throughput so far in MiB/s
+	f32 getPeakThroughput() const { return peakThroughput * BytesPerMsToMiBs; }
+	//! Installed bytes over the sampled time in MiB/s
+	f32 getAverageThroughput() const;
+	//! Number of samples per 1 MiB/s wide throughput bucket, the last one collects everything above
+	const u32 * getHistogram() const { return histogram; }
+	//! Estimated seconds left, 0 if unknown
+	u32 getEta() const { return eta; }
+	const std::string & getInfo() const { return info; }
+
+	static const u32 MinInterval = 50;
+	static const u32 MaxInterval = 250;
+	static const int HistogramBuckets = 32;
+	//! the info is only rebuilt this often unless the percent changed
+	static const u32 InfoInterval = 1000;
+
+private:
+	void updateInterval();
+
+	ProgressSource * source;
+
+	u64 installedSize;
+	u64 totalSize;
+	u64 firstSampleMs;
+	u64 firstInstalled;
+	u64 lastSampleMs;
+	//! bytes per millisecond
+	f32 throughput;
+	f32 peakThroughput;
+	u32 histogram[HistogramBuckets];
+	int percent;
+	u32 eta;
+	u32 interval;
+
+	//! when the info was rebuilt and the speed part it was built with
+	u64 infoMs;
+	std::string speedInfo;
+	std::string info;
+
+	static const f32 BytesPerMsToMiBs;
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include <malloc.h>
+#include <string.h>
+#include <coreinit/thread.h>
+#include "SimInstallBackend.h"
+#include "fs/CFile.hpp"
+#include "fs/DirList.h"
+#include "fs/fs_utils.h"
+
+#define SIM_READ_SIZE           (1024 * 1024)
+
+SimInstallBackend::SimInstallBackend()
+	: rate(20 * 1024 * 1024)
+	, freeSpace((u64) -1)
+	, injectedError(0)
+	, injectedErrorPercent(0)
+	, installThread(NULL)
+	, current(NULL)
+	, abortInstall(false)
+	, installCompleted(false)
+	, installError(0)
+	, installedSize(0)
+{
+}
+
+SimInstallBackend::~SimInstallBackend()
+{
+	abortInstall = true;
+	finish();
+}
+
+int SimInstallBackend::prepare(InstallTask * task)
+{
+	task->installFolder = task->path;
+
+	//! MCP_InstallGetInfo fails without a readable title.tmd
+	if(!task->manifest.isValid())
+		return ERROR_INSTALL_INFO;
+
+	task->titleIdHigh = task->manifest.getTitleIdHigh();
+	task->titleIdLow = task->manifest.getTitleIdLow();
+
+	bool spoofFiles = false;
+	if(!isInstallableTitle(task->titleIdHigh, task->titleIdLow, spoofFiles))
+		return ERROR_TITLE_TYPE;
+
+	if(spoofFiles)
+		task->target = NAND;
+
+	SimTaskData * data = new SimTaskData;
+	data->totalSize = 0;
+	data->hasTicket = (CheckFile((task->path + "/title.tik").c_str()) != 0);
+	task->backendData = data;
+
+	DirList dir(task->path, ".app", DirList::Files | DirList::Stats);
+	for(int i = 0; i < dir.GetFilecount(); i++)
+	{
+		data->files.push_back(dir.GetFilepath(i));
+		data->totalSize += dir.GetFilesize(i);
+	}
+
+	return INSTALL_OK;
+}
+
+void SimInstallBackend::release(InstallTask * task)
+{
+	SimTaskData * data = (SimTaskData *) task->backendData;
+
+	delete data;
+	task->backendData = NULL;
+}
+
+int SimInstallBackend::start(InstallTask * task)
+{
+	finish();
+
+	current = (SimTaskData *) task->backendData;
+	installCompleted = false;
+	installError = 0;
+	installedSize = 0;
+	abortInstall = false;
+
+	if(!current)
+		return ERROR_INSTALL_START;
+
+	installThread = CThread::create(SimInstallBackend::installCallback, this, CThread::eAttributeAffCore2);
+	if(!installThread)
+		return ERROR_INSTALL_START;
+
+	installThread->resumeThread();
+	return INSTALL_OK;
+}
+
+void SimInstallBackend::finish()
+{
+	if(installThread)
+	{
+		delete installThread;
+		installThread = NULL;
+	}
+
+	current = NULL;
+}
+
+bool SimInstallBackend::getProgress(u64 & installed, u64 & total)
+{
+	if(!current || installCompleted)
+		return false;
+
+	installed = installedSize;
+	total = current->totalSize;
+	return true;
+}
+
+void SimInstallBackend::installCallback(CThread *thread, void *arg)
+{
+	((SimInstallBackend *) arg)->install();
+}
+
+void SimInstallBackend::install()
+{
+	//! MCP checks the ticket and the free space before writing anything
+	if(!current->hasTicket)
+	{
+		installError = MCP_ERROR_TICKET;
+		installCompleted = true;
+		return;
+	}
+
+	if(current->totalSize > freeSpace)
+	{
+		installError = MCP_ERROR_NO_SPACE;
+		installCompleted = true;
+		return;
+	}
+
+	u8 * buffer = (u8 *) memalign(0x40, SIM_READ_SIZE);
+	if(!buffer)
+	{
+		installError = MCP_ERROR_SD_READ;
+		installCompleted = true;
+		return;
+	}
+
+	u64 failAt = (u64) -1;
+	if(injectedError && injectedErrorPercent >= 0)
+		failAt = current->totalSize * injectedErrorPercent / 100;
+
+	OSTime startTime = OSGetTime();
+	u64 installed = 0;
+	u32 error = 0;
+
+	for(u32 i = 0; i < current->files.size() && !error && !abortInstall; i++)
+	{
+		CFile file(current->files[i], CFile::ReadOnly);
+		if(!file.isOpen())
+		{
+			error = MCP_ERROR_SD_READ;
+			break;
+		}
+
+		while(!abortInstall)
+		{
+			int ret = file.read(buffer, SIM_READ_SIZE);
+			if(ret < 0)
+				error = MCP_ERROR_SD_READ;
+			if(ret <= 0)
+				break;
+
+			installed += ret;
+			installedSize = installed;
+
+			if(installed >= failAt)
+			{
+				error = injectedError;
+				break;
+			}
+
+			//! throttle to the configured rate
+			if(rate)
+			{
+				u64 expectedMs = installed * 1000 / rate;
+				u64 passedMs = OSTicksToMilliseconds(OSGetTime() - startTime);
+				if(expectedMs > passedMs)
+					OSSleepTicks(OSMillisecondsToTicks(expectedMs - passedMs));
+			}
+		}
+	}
+
+	free(buffer);
+
+	installError = error;
+	installCompleted = true;
+}
@@ -0,0 +1,70 @@
+#ifndef SIM_INSTALL_BACKEND_H_
+#define SIM_INSTALL_BACKEND_H_
+
+#include <vector>
+#include <string>
+#include "InstallBackend.h"
+#include "system/CThread.h"
+
+//! Behaves like MCP without installing anything. It reads the .app files
+//! of the title at a configurable rate and reports progress and the error
+//! codes MCP would report. Used to profile the install pipeline.
+class SimInstallBackend : public InstallBackend
+{
+public:
+	SimInstallBackend();
+	virtual ~SimInstallBackend();
+
+	//! bytes per second, 0 reads as fast as the sd card allows
+	void setRate(u64 bytesPerSecond) { rate = bytesPerSecond; }
+	//! free space on the simulated target
+	void setFreeSpace(u64 bytes) { freeSpace = bytes; }
+	//! fail every install with error once percent of it is done, error 0 disables it
+	void setInjectedError(u32 error, int percent) { injectedError = error; injectedErrorPercent = percent; }
+
+	int prepare(InstallTask * task);
+	void release(InstallTask * task);
+
+	int start(InstallTask * task);
+	bool isCompleted() { return installCompleted; }
+	u32 getInstallError() { return installError; }
+	void finish();
+
+	bool getFreeSpace(int target, u64 & freeBytes) { freeBytes = freeSpace; return (freeSpace != (u64) -1); }
+
+	bool getProgress(u64 & installedSize, u64 & totalSize);
+
+	//! error codes as MCP reports them
+	enum
+	{
+		MCP_ERROR_TICKET = 0xFFFBF446,
+		MCP_ERROR_NO_SPACE = 0xFFFCFFE4,
+		MCP_ERROR_SD_READ = 0xFFFFF825
+	};
+
+private:
+	static void installCallback(CThread *thread, void *arg);
+	void install();
+
+	typedef struct
+	{
+		std::vector<std::string> files;
+		u64 totalSize;
+		bool hasTicket;
+	} SimTaskData;
+
+	u64 rate;
+	u64 freeSpace;
+	u32 injectedError;
+	int injectedErrorPercent;
+
+	CThread * installThread;
+	SimTaskData * current;
+
+	volatile bool abortInstall;
+	volatile bool installCompleted;
+	volatile u32 installError;
+	volatile u64 installedSize;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include "SpacePlanner.h"
+
+static bool CompareSize(const std::pair<u64, int> & a, const std::pair<u64, int> & b)
+{
+	return a.first < b.first;
+}
+
+std::vector<int> SpacePlanner::select(const std::vector<u64> & sizes, u64 capacity, int policy)
+{
+	if(policy == POLICY_MOST_BYTES)
+		return selectKnapsack(sizes, capacity);
+
+	return selectGreedy(sizes, capacity);
+}
+
+std::vector<int> SpacePlanner::selectGreedy(const std::vector<u64> & sizes, u64 capacity)
+{
+	std::vector< std::pair<u64, int> > sorted;
+	for(u32 i = 0; i < sizes.size(); i++)
+		sorted.push_back(std::make_pair(sizes[i], (int)i));
+
+	std::stable_sort(sorted.begin(), sorted.end(), CompareSize);
+
+	std::vector<int> chosen;
+	u64 used = 0;
+
+	for(u32 i = 0; i < sorted.size(); i++)
+	{
+		if(used + sorted[i].first > capacity)
+			break;
+
+		used += sorted[i].first;
+		chosen.push_back(sorted[i].second);
+	}
+
+	std::sort(chosen.begin(), chosen.end());
+	return chosen;
+}
+
+std::vector<int> SpacePlanner::selectKnapsack(const std::vector<u64> & sizes, u64 capacity)
+{
+	//! work in units so the table stays small, sizes are rounded up and the
+	//! capacity down so whatever gets chosen really fits
+	u64 unit = capacity / MaxUnits + 1;
+	u32 units = capacity / unit;
+	u32 count = sizes.size();
+
+	std::vector<u32> weight(count);
+	for(u32 i = 0; i < count; i++)
+	{
+		u64 w = (sizes[i] + unit - 1) / unit;
+		weight[i] = (w > units) ? units + 1 : (u32)w;
+	}
+
+	//! best[c] is the most units that fit into c, taken[i] remembers the decisions
+	std::vector<u32> best(units + 1, 0);
+	std::vector< std::vector<bool> > taken(count, std::vector<bool>(units + 1, false));
+
+	for(u32 i = 0; i < count; i++)
+	{
+		if(weight[i] > units)
+			continue;
+
+		for(u32 c = units; c >= weight[i]; c--)
+		{
+			u32 with = best[c - weight[i]] + weight[i];
+			if(with > best[c])
+			{
+				best[c] = with;
+				taken[i][c] = true;
+			}
+
+			if(c == 0)
+				break;
+		}
+	}
+
+	std::vector<int> chosen;
+	u32 c = units;
+
+	for(int i = count - 1; i >= 0; i--)
+	{
+		//! titles of unknown size cost nothing and are always kept
+		if(weight[i] == 0 || taken[i][c])
+		{
+			chosen.push_back(i);
+			c -= weight[i];
+		}
+	}
+
+	std::reverse(chosen.begin(), chosen.end());
+	return chosen;
+}
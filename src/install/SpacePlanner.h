@@ -0,0 +1,30 @@
+#ifndef SPACE_PLANNER_H_
+#define SPACE_PLANNER_H_
+
+#include <vector>
+#include "common/types.h"
+
+//! Picks the titles of a batch that fit into the free space of the target
+class SpacePlanner
+{
+public:
+	enum Policy
+	{
+		//! smallest titles first, installs as many titles as possible
+		POLICY_MOST_TITLES,
+		//! 0/1 knapsack, uses as much of the free space as possible
+		POLICY_MOST_BYTES
+	};
+
+	//! Returns the positions in sizes of the chosen titles in ascending order
+	static std::vector<int> select(const std::vector<u64> & sizes, u64 capacity, int policy);
+
+private:
+	static std::vector<int> selectGreedy(const std::vector<u64> & sizes, u64 capacity);
+	static std::vector<int> selectKnapsack(const std::vector<u64> & sizes, u64 capacity);
+
+	//! upper bound of capacity units in the knapsack table, sizes get rounded up to fit
+	static const u32 MaxUnits = 0x10000;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "TitleIndex.h"
+#include "McpTitleIndex.h"
+#include "InstallBackend.h"
+
+TitleIndex * TitleIndex::titleIndexInstance = NULL;
+
+TitleIndex * TitleIndex::instance()
+{
+	//! the simulated install does not change the console, nothing is installed there
+	if(!titleIndexInstance)
+	{
+#ifdef SIMULATED_INSTALL
+		titleIndexInstance = new FakeTitleIndex();
+#else
+		titleIndexInstance = new McpTitleIndex();
+#endif
+	}
+
+	return titleIndexInstance;
+}
+
+void TitleIndex::destroyInstance()
+{
+	if(titleIndexInstance)
+	{
+		delete titleIndexInstance;
+		titleIndexInstance = NULL;
+	}
+}
+
+void TitleIndex::ensureLoaded()
+{
+	if(loaded)
+		return;
+
+	//! a failed load leaves the index empty, nothing gets skipped then
+	load();
+	loaded = true;
+}
+
+bool TitleIndex::isInstalled(u64 titleId, u16 version, int target)
+{
+	if(target != InstallBackend::NAND && target != InstallBackend::USB)
+		return false;
+
+	indexMutex.lock();
+	ensureLoaded();
+
+	std::unordered_map<u64, u16>::const_iterator itr = titles[target].find(titleId);
+	bool installed = (itr != titles[target].end()) && (itr->second >= version);
+
+	indexMutex.unlock();
+
+	return installed;
+}
+
+void TitleIndex::add(u64 titleId, u16 version, int target)
+{
+	indexMutex.lock();
+	insert(titleId, version, target);
+	indexMutex.unlock();
+}
+
+void TitleIndex::insert(u64 titleId, u16 version, int target)
+{
+	if(target != InstallBackend::NAND && target != InstallBackend::USB)
+		return;
+
+	std::unordered_map<u64, u16>::iterator itr = titles[target].find(titleId);
+	if(itr == titles[target].end() || itr->second < version)
+		titles[target][titleId] = version;
+}
+
+int TitleIndex::getCount(int target)
+{
+	if(target != InstallBackend::NAND && target != InstallBackend::USB)
+		return 0;
+
+	indexMutex.lock();
+	ensureLoaded();
+	int count = titles[target].size();
+	indexMutex.unlock();
+
+	return count;
+}
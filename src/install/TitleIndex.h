@@ -0,0 +1,55 @@
+#ifndef TITLE_INDEX_H_
+#define TITLE_INDEX_H_
+
+#include <unordered_map>
+#include "common/types.h"
+#include "system/CMutex.h"
+
+//! Titles and versions that are installed on NAND and USB.
+//! Built once per session on the first lookup and kept up to date
+//! with what gets installed afterwards.
+class TitleIndex
+{
+public:
+	static TitleIndex * instance();
+	static void destroyInstance();
+
+	virtual ~TitleIndex() {}
+
+	//! true if the title is on the target in this version or a newer one
+	bool isInstalled(u64 titleId, u16 version, int target);
+	//! records a title installed in this session
+	void add(u64 titleId, u16 version, int target);
+
+	int getCount(int target);
+
+protected:
+	TitleIndex() : loaded(false) {}
+
+	//! fills the index with insert(), called once before the first lookup
+	virtual bool load() = 0;
+	//! add() without taking the lock, load() is called with it held
+	void insert(u64 titleId, u16 version, int target);
+
+private:
+	void ensureLoaded();
+
+	static TitleIndex * titleIndexInstance;
+
+	//! title id to version, one map per target
+	std::unordered_map<u64, u16> titles[2];
+	bool loaded;
+	CMutex indexMutex;
+};
+
+//! Index without a console behind it, filled by hand through add()
+class FakeTitleIndex : public TitleIndex
+{
+public:
+	FakeTitleIndex() {}
+
+protected:
+	bool load() { return true; }
+};
+
+#endif
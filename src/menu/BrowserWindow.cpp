@@ -15,8 +15,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  ****************************************************************************/
 #include "BrowserWindow.h"
+#include "utils/logger.h"
+#include "utils/StringTools.h"
 
 #define MAX_FOLDERS_PER_PAGE 3
+//! room for the content size on the right of a folder row
+#define SIZE_TEXT_WIDTH 180
 
 BrowserWindow::BrowserWindow(int w, int h, CFolderList * list)
     : GuiFrame(w, h)
@@ -37,6 +41,7 @@ BrowserWindow::BrowserWindow(int w, int h, CFolderList * list)
 	, plusTxt("选择全部", 42, glm::vec4(0.9f, 0.9f, 0.9f, 1.0f))
 	, minusTxt("取消全选", 42, glm::vec4(0.9f, 0.9f, 0.9f, 1.0f))
 	, installTxt("安装", 42, glm::vec4(0.9f, 0.9f, 0.9f, 1.0f))
+	, scanTxt("正在扫描...", 36, glm::vec4(0.9f, 0.9f, 0.9f, 1.0f))
     , touchTrigger(GuiTrigger::CHANNEL_1, GuiTrigger::VPAD_TOUCH)
     , buttonATrigger(GuiTrigger::CHANNEL_ALL, GuiTrigger::BUTTON_A, true)
     , buttonUpTrigger(GuiTrigger::CHANNEL_ALL, GuiTrigger::BUTTON_UP | GuiTrigger::STICK_L_UP, true)
@@ -54,52 +59,29 @@ BrowserWindow::BrowserWindow(int w, int h, CFolderList * list)
 	folderList = list;
 	pageIndex = 0;
 	selectedItem = -1;
+	scanning = folderList->IsScanning();
+	scanStart = OSGetTime();
 	
     buttonCount = folderList->GetCount();
 	folderButtons.resize(buttonCount);
 	
 	for(int i = 0; i < buttonCount; i++)
-	{      
-		folderButtons[i].folderButtonImg = new GuiImage(buttonImageData);
-		folderButtons[i].folderButtonCheckedImg = new GuiImage(buttonCheckedImageData);
-		folderButtons[i].folderButtonHighlightedImg = new GuiImage(buttonHighlightedImageData);
-		folderButtons[i].folderButton = new GuiButton(folderButtons[i].folderButtonImg->getWidth(), folderButtons[i].folderButtonImg->getHeight());
-		
-		folderButtons[i].folderButtonText = new GuiText(folderList->GetName(i).c_str(), 42, glm::vec4(0.9f, 0.9f, 0.9f, 1.0f));
-		folderButtons[i].folderButtonText->setMaxWidth(folderButtons[i].folderButtonImg->getWidth() - 70, GuiText::DOTTED);
-		folderButtons[i].folderButtonText->setPosition(35, 0);
-		
-		folderButtons[i].folderButtonTextOver = new GuiText(folderList->GetName(i).c_str(), 42, glm::vec4(0.9f, 0.9f, 0.9f, 1.0f));
-		folderButtons[i].folderButtonTextOver->setMaxWidth(folderButtons[i].folderButtonImg->getWidth() - 94, GuiText::SCROLL_HORIZONTAL);
-		folderButtons[i].folderButtonTextOver->setPosition(35, 0);
-		
-		folderButtons[i].folderButton->setImageSelectOver(folderButtons[i].folderButtonHighlightedImg);
-		folderButtons[i].folderButton->setLabel(folderButtons[i].folderButtonText);
-		folderButtons[i].folderButton->setLabelOver(folderButtons[i].folderButtonTextOver);
-		folderButtons[i].folderButton->setSoundClick(buttonClickSound);
-		folderButtons[i].folderButton->setImage(folderButtons[i].folderButtonImg);
-		folderButtons[i].folderButton->setImageChecked(folderButtons[i].folderButtonCheckedImg);
-		if(folderList->IsSelected(i))
-			folderButtons[i].folderButton->check();
-		
+	{
+		folderButtons[i] = CreateFolderButton(i);
 		folderButtons[i].folderButton->setPosition(0, 150 - (folderButtons[i].folderButtonImg->getHeight() + 30) * i);
-		folderButtons[i].folderButton->setAlignment(ALIGN_LEFT | ALIGN_MIDDLE);
-        folderButtons[i].folderButton->setTrigger(&touchTrigger);
-		folderButtons[i].folderButton->clicked.connect(this, &BrowserWindow::OnFolderButtonClick);
-		
 		this->append(folderButtons[i].folderButton);
 	}
 	
 	if(buttonCount > MAX_FOLDERS_PER_PAGE)
-    {
-		scrollbar.SetPageSize(MAX_FOLDERS_PER_PAGE);
-        scrollbar.SetEntrieCount(buttonCount);
-        scrollbar.setAlignment(ALIGN_RIGHT | ALIGN_MIDDLE);
-        scrollbar.setPosition(0, -30);
-		scrollbar.SetSelected(0, 0);
-        scrollbar.listChanged.connect(this, &BrowserWindow::OnScrollbarListChange);
-        this->append(&scrollbar);
-    }
+		ShowScrollbar();
+	
+	//! the rows of a running scan are added in updateEffects()
+	if(scanning)
+	{
+		scanTxt.setAlignment(ALIGN_LEFT | ALIGN_BOTTOM);
+		scanTxt.setPosition(35, 30);
+		this->append(&scanTxt);
+	}
 	
 	DPADButtons.setTrigger(&buttonUpTrigger);
     DPADButtons.setTrigger(&buttonDownTrigger);
@@ -169,14 +151,7 @@ BrowserWindow::BrowserWindow(int w, int h, CFolderList * list)
 BrowserWindow::~BrowserWindow()
 {
     for(u32 i = 0; i < folderButtons.size(); ++i)
-    {
-        delete folderButtons[i].folderButtonImg;
-        delete folderButtons[i].folderButtonCheckedImg;
-        delete folderButtons[i].folderButtonHighlightedImg;
-        delete folderButtons[i].folderButton;
-        delete folderButtons[i].folderButtonText;
-        delete folderButtons[i].folderButtonTextOver;
-    }
+        DeleteFolderButton(folderButtons[i]);
 	
 	folderButtons.clear();
    
@@ -194,6 +169,235 @@ BrowserWindow::~BrowserWindow()
     Resources::RemoveSound(buttonClickSound);
 }
 
+BrowserWindow::FolderButton BrowserWindow::CreateFolderButton(int i)
+{
+	FolderButton folderButton;
+	folderButton.folderButtonImg = new GuiImage(buttonImageData);
+	folderButton.folderButtonCheckedImg = new GuiImage(buttonCheckedImageData);
+	folderButton.folderButtonHighlightedImg = new GuiImage(buttonHighlightedImageData);
+	folderButton.folderButton = new GuiButton(folderButton.folderButtonImg->getWidth(), folderButton.folderButtonImg->getHeight());
+	
+	folderButton.folderButtonText = new GuiText(folderList->GetName(i).c_str(), 42, GetFolderTextColor(i));
+	folderButton.folderButtonText->setMaxWidth(folderButton.folderButtonImg->getWidth() - 70 - SIZE_TEXT_WIDTH, GuiText::DOTTED);
+	folderButton.folderButtonText->setPosition(35, 0);
+	
+	folderButton.folderButtonTextOver = new GuiText(folderList->GetName(i).c_str(), 42, GetFolderTextColor(i));
+	folderButton.folderButtonTextOver->setMaxWidth(folderButton.folderButtonImg->getWidth() - 94 - SIZE_TEXT_WIDTH, GuiText::SCROLL_HORIZONTAL);
+	folderButton.folderButtonTextOver->setPosition(35, 0);
+	
+	folderButton.folderButtonSizeText = new GuiText(GetSizeText(i).c_str(), 36, glm::vec4(0.9f, 0.9f, 0.9f, 1.0f));
+	folderButton.folderButtonSizeText->setAlignment(ALIGN_RIGHT | ALIGN_MIDDLE);
+	folderButton.folderButtonSizeText->setPosition(-35, 0);
+	
+	folderButton.folderButton->setImageSelectOver(folderButton.folderButtonHighlightedImg);
+	folderButton.folderButton->setLabel(folderButton.folderButtonText);
+	folderButton.folderButton->setLabelOver(folderButton.folderButtonTextOver);
+	folderButton.folderButton->setLabel(folderButton.folderButtonSizeText, 1);
+	folderButton.folderButton->setSoundClick(buttonClickSound);
+	folderButton.folderButton->setImage(folderButton.folderButtonImg);
+	folderButton.folderButton->setImageChecked(folderButton.folderButtonCheckedImg);
+	if(folderList->IsSelected(i))
+		folderButton.folderButton->check();
+	
+	folderButton.folderButton->setAlignment(ALIGN_LEFT | ALIGN_MIDDLE);
+	folderButton.folderButton->setTrigger(&touchTrigger);
+	folderButton.folderButton->clicked.connect(this, &BrowserWindow::OnFolderButtonClick);
+	
+	return folderButton;
+}
+
+void BrowserWindow::DeleteFolderButton(FolderButton & folderButton)
+{
+	delete folderButton.folderButtonImg;
+	delete folderButton.folderButtonCheckedImg;
+	delete folderButton.folderButtonHighlightedImg;
+	delete folderButton.folderButton;
+	delete folderButton.folderButtonText;
+	delete folderButton.folderButtonTextOver;
+	delete folderButton.folderButtonSizeText;
+}
+
+glm::vec4 BrowserWindow::GetFolderTextColor(int i)
+{
+	//! folders holding a title that is in another folder as well are tinted
+	return folderList->IsDuplicate(i) ? glm::vec4(1.0f, 0.8f, 0.3f, 1.0f) : glm::vec4(0.9f, 0.9f, 0.9f, 1.0f);
+}
+
+std::string BrowserWindow::GetSizeText(int i)
+{
+	//! folders without a TMD get their size from the size worker a bit later
+	if(!folderList->IsSizeKnown(i))
+		return "...";
+	
+	u64 size = folderList->GetSize(i);
+	if(size >= 1073741824ULL)
+		return strfmt("%0.1f GB", size / 1073741824.0f);
+	
+	return strfmt("%0.0f MB", size / 1048576.0f);
+}
+
+void BrowserWindow::ShowScrollbar()
+{
+	scrollbar.SetPageSize(MAX_FOLDERS_PER_PAGE);
+	scrollbar.SetEntrieCount(buttonCount);
+	scrollbar.setAlignment(ALIGN_RIGHT | ALIGN_MIDDLE);
+	scrollbar.setPosition(0, -30);
+	scrollbar.SetSelected(0, 0);
+	scrollbar.listChanged.connect(this, &BrowserWindow::OnScrollbarListChange);
+	this->append(&scrollbar);
+}
+
+void BrowserWindow::updateEffects()
+{
+	GuiFrame::updateEffects();
+	
+	if(folderList->IsSizing())
+	{
+		std::vector<int> sized = folderList->FetchSizes();
+		for(u32 i = 0; i < sized.size(); i++)
+		{
+			if(sized[i] < buttonCount)
+				folderButtons[sized[i]].folderButtonSizeText->setText(GetSizeText(sized[i]).c_str());
+		}
+	}
+	
+	if(!scanning)
+		return;
+	
+	int oldCount = buttonCount;
+	
+	if(folderList->Fetch() > 0)
+		AddFolderButtons();
+	
+	if(oldCount == 0 && buttonCount > 0)
+		log_printf("BrowserWindow: first row after %u ms\n", (u32)OSTicksToMilliseconds(OSGetTime() - scanStart));
+	
+	if(folderList->IsScanning())
+	{
+		scanTxt.setTextf("正在扫描... %d", buttonCount);
+		return;
+	}
+	
+	//! the worker may have added the last folders after the fetch above
+	if(folderList->Fetch() > 0)
+		AddFolderButtons();
+	
+	log_printf("BrowserWindow: scan of %d folders took %u ms\n", buttonCount, (u32)OSTicksToMilliseconds(OSGetTime() - scanStart));
+	
+	scanning = false;
+	this->remove(&scanTxt);
+	
+	scanFinished(this);
+	
+	if(buttonCount == 0)
+		folderListEmpty(this);
+}
+
+void BrowserWindow::AddFolderButtons()
+{
+	int oldCount = buttonCount;
+	buttonCount = folderList->GetCount();
+	folderButtons.resize(buttonCount);
+	
+	for(int i = oldCount; i < buttonCount; i++)
+	{
+		folderButtons[i] = CreateFolderButton(i);
+		folderButtons[i].folderButton->setPosition(0, 150 - (folderButtons[i].folderButtonImg->getHeight() + 30) * (i - pageIndex));
+		this->append(folderButtons[i].folderButton);
+	}
+	
+	//! a new folder can turn folders that are already listed into duplicates
+	for(int i = 0; i < oldCount; i++)
+	{
+		folderButtons[i].folderButtonText->setColor(GetFolderTextColor(i));
+		folderButtons[i].folderButtonTextOver->setColor(GetFolderTextColor(i));
+	}
+	
+	if(buttonCount > MAX_FOLDERS_PER_PAGE && oldCount <= MAX_FOLDERS_PER_PAGE)
+		ShowScrollbar();
+	else if(buttonCount > MAX_FOLDERS_PER_PAGE)
+		scrollbar.SetEntrieCount(buttonCount);
+}
+
+void BrowserWindow::Refresh(const CFolderList::Changes & changes)
+{
+	int oldCount = buttonCount;
+	std::vector<FolderButton> buttons(folderList->GetCount());
+	std::vector<bool> kept(buttons.size(), false);
+	
+	//! rows of folders that are still there only move, nothing is created for them
+	for(u32 i = 0; i < folderButtons.size(); i++)
+	{
+		int n = (i < changes.oldToNew.size()) ? changes.oldToNew[i] : -1;
+		
+		if(n < 0 || n >= (int) buttons.size())
+		{
+			this->remove(folderButtons[i].folderButton);
+			DeleteFolderButton(folderButtons[i]);
+			continue;
+		}
+		
+		folderButtons[i].folderButton->clearState(STATE_SELECTED);
+		buttons[n] = folderButtons[i];
+		kept[n] = true;
+	}
+	
+	for(u32 i = 0; i < changes.added.size(); i++)
+	{
+		int n = changes.added[i];
+		if(n < 0 || n >= (int) buttons.size() || kept[n])
+			continue;
+		
+		buttons[n] = CreateFolderButton(n);
+		this->append(buttons[n].folderButton);
+		kept[n] = true;
+	}
+	
+	folderButtons.swap(buttons);
+	buttonCount = folderButtons.size();
+	
+	//! the folder holds another title or version now
+	for(u32 i = 0; i < changes.updated.size(); i++)
+	{
+		int n = changes.updated[i];
+		if(n < 0 || n >= buttonCount || !kept[n])
+			continue;
+		
+		folderButtons[n].folderButtonText->setText(folderList->GetName(n).c_str());
+		folderButtons[n].folderButtonTextOver->setText(folderList->GetName(n).c_str());
+		folderButtons[n].folderButtonSizeText->setText(GetSizeText(n).c_str());
+	}
+	
+	//! a folder that was added, removed or updated can change which titles are duplicates
+	for(int i = 0; i < buttonCount; i++)
+	{
+		folderButtons[i].folderButtonText->setColor(GetFolderTextColor(i));
+		folderButtons[i].folderButtonTextOver->setColor(GetFolderTextColor(i));
+		
+		//! the size worker sums up the folders without a TMD again
+		if(!folderList->IsSizeKnown(i))
+			folderButtons[i].folderButtonSizeText->setText(GetSizeText(i).c_str());
+	}
+	
+	if(buttonCount > MAX_FOLDERS_PER_PAGE && oldCount <= MAX_FOLDERS_PER_PAGE)
+	{
+		ShowScrollbar();
+	}
+	else if(buttonCount <= MAX_FOLDERS_PER_PAGE && oldCount > MAX_FOLDERS_PER_PAGE)
+	{
+		scrollbar.listChanged.disconnect(this);
+		this->remove(&scrollbar);
+	}
+	else if(buttonCount > MAX_FOLDERS_PER_PAGE)
+	{
+		scrollbar.SetEntrieCount(buttonCount);
+		scrollbar.SetSelected(0, 0);
+	}
+	
+	OnScrollbarListChange(0, 0);
+	UpdateChecks();
+}
+
 int BrowserWindow::SearchSelectedButton()
 {
 	int index = -1;
@@ -235,6 +439,18 @@ void BrowserWindow::OnFolderButtonClick(GuiButton *button, const GuiController *
 		else
 			folderButtons[i].folderButton->clearState(STATE_SELECTED);
 	}
+	
+	UpdateChecks();
+}
+
+void BrowserWindow::UpdateChecks()
+{
+	//! selecting a title unselects its other folders
+	for(int i = 0; i < buttonCount; i++)
+	{
+		if(folderButtons[i].folderButton->isChecked() != folderList->IsSelected(i))
+			folderButtons[i].folderButton->check();
+	}
 }
 
 void BrowserWindow::OnAButtonClick(GuiButton *button, const GuiController *controller, GuiTrigger *trigger)
@@ -256,7 +472,7 @@ void BrowserWindow::OnAButtonClick(GuiButton *button, const GuiController *contr
 			return;
 		
 		folderList->Click(index);
-		folderButtons[index].folderButton->check();
+		UpdateChecks();
 	}
 }
 
@@ -289,7 +505,9 @@ void BrowserWindow::OnDPADClick(GuiButton *button, const GuiController *controll
 			if (index >= 0)
 				folderButtons[index].folderButton->clearState(STATE_SELECTED);
 			index = 0;
-			folderButtons[index].folderButton->setState(STATE_SELECTED);
+			//! there are no rows until the scan found the first folder
+			if (buttonCount > 0)
+				folderButtons[index].folderButton->setState(STATE_SELECTED);
 
 			pageIndex = 0;
 			selectedItem = 0;
@@ -360,14 +578,8 @@ void BrowserWindow::OnDPADClick(GuiButton *button, const GuiController *controll
 	
 void BrowserWindow::OnPlusButtonClick(GuiButton *button, const GuiController *controller, GuiTrigger *trigger)
 {
-	for(int i = 0; i < buttonCount; i++)
-	{
-		if(!folderList->IsSelected(i))
-		{
-			folderList->Select(i);
-			folderButtons[i].folderButton->check();
-		}
-	}
+	folderList->SelectAll();
+	UpdateChecks();
 }
 
 void BrowserWindow::OnMinusButtonClick(GuiButton *button, const GuiController *controller, GuiTrigger *trigger)
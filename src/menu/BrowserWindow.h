@@ -17,6 +17,7 @@
 #ifndef _BROWSERWINDOW_H_
 #define _BROWSERWINDOW_H_
 
+#include <coreinit/time.h>
 #include "gui/Gui.h"
 #include "gui/Scrollbar.h"
 #include "fs/CFolderList.hpp"
@@ -27,13 +28,27 @@ public:
     BrowserWindow(int w, int h, CFolderList * folderList);
     virtual ~BrowserWindow();
 	
+	//! Applies what CFolderList::Refresh() changed, only rows of new folders are created
+	void Refresh(const CFolderList::Changes & changes);
+	
+	//! Adds the rows of folders a running scan found
+	void updateEffects();
+	
+	//! true until the rows of every folder the scan found were added
+	bool isScanning() const { return scanning; }
+	
 	sigslot::signal1<GuiElement *> installButtonClicked;
+	//! the scan is done and its last rows were added
+	sigslot::signal1<GuiElement *> scanFinished;
+	//! the scan is done and did not find anything to install
+	sigslot::signal1<GuiElement *> folderListEmpty;
 	
 private:
     int SearchSelectedButton();
     int SearchSelectedRightSideButton();
 	
 	void OnFolderButtonClick(GuiButton *button, const GuiController *controller, GuiTrigger *trigger);
+	void UpdateChecks();
 	void OnDPADClick(GuiButton *button, const GuiController *controller, GuiTrigger *trigger);
 	void OnAButtonClick(GuiButton *button, const GuiController *controller, GuiTrigger *trigger);
 	void OnPlusButtonClick(GuiButton *button, const GuiController *controller, GuiTrigger *trigger);
@@ -64,6 +79,7 @@ private:
 	GuiText plusTxt;
 	GuiText minusTxt;
 	GuiText installTxt;
+	GuiText scanTxt;
     
 	GuiTrigger touchTrigger;
     GuiTrigger buttonATrigger;
@@ -102,10 +118,21 @@ private:
         GuiButton *folderButton;
         GuiText *folderButtonText;
         GuiText *folderButtonTextOver;
+        GuiText *folderButtonSizeText;
     } FolderButton;
 
     std::vector<FolderButton> folderButtons;
 	
+	FolderButton CreateFolderButton(int i);
+	void DeleteFolderButton(FolderButton & folderButton);
+	glm::vec4 GetFolderTextColor(int i);
+	std::string GetSizeText(int i);
+	void ShowScrollbar();
+	void AddFolderButtons();
+	
+	bool scanning;
+	OSTime scanStart;
+	
 	CFolderList * folderList;
 };
 
@@ -15,34 +15,31 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  ****************************************************************************/
+#include <algorithm>
 #include "Application.h"
 #include "InstallWindow.h"
 #include "utils/StringTools.h"
 #include "common/common.h"
 #include "system/power.h"
-#include <coreinit/mcp.h>
-#include <coreinit/memory.h>
-#include <coreinit/ios.h>
-
-#define MCP_COMMAND_INSTALL_ASYNC   0x81
-#define MAX_INSTALL_PATH_LENGTH     0x27F
-
-static int installCompleted = 0;
-static u32 installError = 0;
-
-extern "C" MCPError MCP_GetLastRawError(void);
-
-static void* IosInstallCallback(IOSError errorCode, void * priv_data)
-{
-	installError = errorCode;
-	installCompleted = 1;
-	return 0;
-}
+#include "system/TimerService.h"
+#include "install/ProgressSampler.h"
+#include "install/SpacePlanner.h"
+#include "install/InstallJournal.h"
+#include "install/TitleIndex.h"
 
 InstallWindow::InstallWindow(CFolderList * list)
 	: GuiFrame(0, 0)
 	, CThread(CThread::eAttributeAffCore0 | CThread::eAttributePinnedAff)
 	, folderList(list)
+	, backend(NULL)
+	, queue(NULL)
+	, statsLog(NULL)
+	, verify(false)
+	, orderPolicy(InstallScheduler::POLICY_CLICK_ORDER)
+	, installedCount(0)
+	, skippedCount(0)
+	, failedCount(0)
+	, retryCount(0)
 {   
 	mainWindow = Application::instance()->getMainWindow();
 	
@@ -80,6 +77,9 @@ InstallWindow::~InstallWindow()
 	mainWindow->remove(drcFrame);
 	delete drcFrame;
 	delete messageBox;
+	
+	if(backend)
+		delete backend;
 }
 
 void InstallWindow::OnValidInstallClick(GuiElement * element, int val)
@@ -94,9 +94,125 @@ void InstallWindow::OnValidInstallClick(GuiElement * element, int val)
 void InstallWindow::OnDestinationChoice(GuiElement * element, int choice)
 {
 	if(choice == MessageBox::MR_YES)
-		target = NAND;
+		target = InstallBackend::NAND;
 	else
-		target = USB;
+		target = InstallBackend::USB;
+	
+	messageBox->messageYesClicked.disconnect(this);
+	messageBox->messageNoClicked.disconnect(this);
+	
+	if(!backend)
+		backend = InstallBackend::create();
+	
+	//! find out before the first title whether the whole batch fits
+	u64 freeSpace = 0;
+	std::vector<int> selected = folderList->GetSelectedList();
+	std::vector<u64> sizes;
+	u64 required = 0;
+	
+	for(u32 i = 0; i < selected.size(); i++)
+	{
+		//! titles that are installed already get skipped and take no space
+		const TitleManifest & manifest = folderList->GetManifest(selected[i]);
+		if(manifest.isValid() && TitleIndex::instance()->isInstalled(manifest.getTitleId(), manifest.getVersion(), target))
+			sizes.push_back(0);
+		else
+			sizes.push_back(manifest.getTotalSize());
+		
+		required += sizes[i];
+	}
+	
+	//! an unknown free space does not mean the batch fits
+	if(!backend->getFreeSpace(target, freeSpace))
+	{
+		messageBox->reload("无法获取目标设备的可用空间", fmt("需要 %0.1f GB", required / 1073741824.0f), "仍要安装吗?", MessageBox::BT_YESNO, MessageBox::IT_ICONWARNING);
+		messageBox->messageYesClicked.connect(this, &InstallWindow::OnUnknownSpaceChoice);
+		messageBox->messageNoClicked.connect(this, &InstallWindow::OnCloseWindow);
+		return;
+	}
+	
+	if(required > freeSpace)
+	{
+		std::vector<int> fitting = SpacePlanner::select(sizes, freeSpace, SpacePlanner::POLICY_MOST_BYTES);
+		
+		fittingList.clear();
+		for(u32 i = 0; i < fitting.size(); i++)
+			fittingList.push_back(selected[fitting[i]]);
+		
+		std::string message = fmt("需要 %0.1f GB, 可用 %0.1f GB", required / 1073741824.0f, freeSpace / 1073741824.0f);
+		
+		if(fittingList.empty())
+		{
+			messageBox->reload("空间不足", message, "没有能放得下的软件。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
+			messageBox->messageOkClicked.connect(this, &InstallWindow::OnCloseWindow);
+		}
+		else
+		{
+			messageBox->reload("空间不足", message, fmt("只安装放得下的 %d 个软件吗?", (int)fittingList.size()), MessageBox::BT_YESNO, MessageBox::IT_ICONWARNING);
+			messageBox->messageYesClicked.connect(this, &InstallWindow::OnSpaceChoice);
+			messageBox->messageNoClicked.connect(this, &InstallWindow::OnCloseWindow);
+		}
+		return;
+	}
+	
+	AskVerify();
+}
+
+void InstallWindow::OnSpaceChoice(GuiElement * element, int choice)
+{
+	messageBox->messageYesClicked.disconnect(this);
+	messageBox->messageNoClicked.disconnect(this);
+	
+	//! keep the click order of the titles that fit
+	std::vector<int> selected = folderList->GetSelectedList();
+	for(u32 i = 0; i < selected.size(); i++)
+	{
+		if(std::find(fittingList.begin(), fittingList.end(), selected[i]) == fittingList.end())
+			folderList->UnSelect(selected[i]);
+	}
+	
+	folderCount = folderList->GetSelectedCount();
+	
+	AskVerify();
+}
+
+void InstallWindow::OnUnknownSpaceChoice(GuiElement * element, int choice)
+{
+	messageBox->messageYesClicked.disconnect(this);
+	messageBox->messageNoClicked.disconnect(this);
+	
+	AskVerify();
+}
+
+void InstallWindow::AskVerify()
+{
+	messageBox->reload("安装前校验WUP文件吗?", "校验会读取全部文件,需要一些时间。", "", MessageBox::BT_YESNO, MessageBox::IT_ICONQUESTION);
+	messageBox->messageYesClicked.connect(this, &InstallWindow::OnVerifyChoice);
+	messageBox->messageNoClicked.connect(this, &InstallWindow::OnVerifyChoice);
+}
+
+void InstallWindow::OnVerifyChoice(GuiElement * element, int choice)
+{
+	verify = (choice == MessageBox::MR_YES);
+	
+	messageBox->messageYesClicked.disconnect(this);
+	messageBox->messageNoClicked.disconnect(this);
+	
+	//! a single title has nothing to order
+	if(folderCount < 2)
+	{
+		startInstalling();
+		return;
+	}
+	
+	messageBox->reload("先安装小的软件吗?", "游戏和它的更新、DLC会一起安装。", "选否则按选择的顺序安装。", MessageBox::BT_YESNO, MessageBox::IT_ICONQUESTION);
+	messageBox->messageYesClicked.connect(this, &InstallWindow::OnOrderChoice);
+	messageBox->messageNoClicked.connect(this, &InstallWindow::OnOrderChoice);
+}
+
+void InstallWindow::OnOrderChoice(GuiElement * element, int choice)
+{
+	orderPolicy = (choice == MessageBox::MR_YES) ? InstallScheduler::POLICY_SMALLEST_FIRST : InstallScheduler::POLICY_CLICK_ORDER;
 	
 	messageBox->messageYesClicked.disconnect(this);
 	messageBox->messageNoClicked.disconnect(this);
@@ -115,29 +231,58 @@ void InstallWindow::executeThread()
 	if(APD_enabled)
 		disableAutoPowerDown();
 	
-	int total = folderList->GetSelectedCount();
+	if(!backend)
+		backend = InstallBackend::create();
+	
+	statsLog = new InstallStatsLog();
+	queue = new InstallQueue(folderList, backend, target, orderPolicy);
+	queue->setVerify(verify);
+	queue->start();
+	
+	int total = queue->getCount();
+	
+	//! lets the next launch pick up where a power loss stopped the batch
+	InstallJournal journal;
+	std::vector<std::string> paths;
+	for(int i = 0; i < total; i++)
+		paths.push_back(queue->getTask(i)->path);
+	journal.begin(paths);
 	int pos = 1;
 	
-	while(pos <= total && !canceled)
+	InstallTask * task = NULL;
+	
+	while(!canceled && (task = queue->next()) != NULL)
 	{
-		InstallProcess(pos, total);
+		journal.started(pos - 1);
 		
-		if(pos < total)
+		int result = InstallProcess(task, pos, total);
+		queue->finish(task);
+		
+		if(result >= 0)
+			journal.completed(pos - 1);
+		else
+			journal.failed(pos - 1, result);
+		
+		if(pos < total && !canceled)
 		{
-			int time = 6;
-			u64 startTime = OSGetTime();
-			u32 passedMs = 0;
+			//! the callback runs on the timer thread, it only gets the counter and the box
+			volatile int time = 6;
+			MessageBox * box = messageBox;
+			u64 endTime = OSGetTime() + OSMillisecondsToTicks(time * 1000);
 			
-			while(time && !canceled)
-			{
-				passedMs = OSTicksToMilliseconds(OSGetTime() - startTime);
-				
-				if(passedMs >= 1000)
-				{
+			TimerGuard countdown(TimerService::instance()->addTimer(1000, 1000, [&time, box]() {
+				if(time > 0)
 					time--;
-					startTime = OSGetTime();
-					messageBox->setMessage2(fmt("%d秒后开始安装下个软件", time));
-				}
+				box->setMessage2(strfmt("%d秒后开始安装下个软件", time));
+			}));
+			
+			//! sleeps until the countdown ran out or the user canceled
+			u64 now = OSGetTime();
+			
+			while(now < endTime && !canceled)
+			{
+				TimerService::instance()->sleep(OSTicksToMilliseconds(endTime - now), &wakeEvent);
+				now = OSGetTime();
 			}
 			
 			messageBox->messageCancelClicked.disconnect(this);
@@ -146,6 +291,27 @@ void InstallWindow::executeThread()
 		pos++;
 	}
 	
+	journal.end();
+	
+	//! one summary for the whole batch unless it was stopped
+	if(!canceled)
+	{
+		std::string message = fmt("成功 %d 个, 已安装跳过 %d 个, 失败 %d 个", installedCount, skippedCount, failedCount);
+		std::string retries = (retryCount > 0) ? fmt("共重试 %d 次", retryCount) : "";
+		
+		messageBox->reload((failedCount > 0) ? "安装结束" : "安装完成", message, retries, MessageBox::BT_OK, (failedCount > 0) ? MessageBox::IT_ICONWARNING : MessageBox::IT_ICONTRUE);
+		messageBox->messageOkClicked.connect(this, &InstallWindow::OnCloseWindow);
+	}
+	
+	queue->stop();
+	queue->logTimings();
+	delete queue;
+	queue = NULL;
+	delete statsLog;
+	statsLog = NULL;
+	delete backend;
+	backend = NULL;
+	
 	if(APD_enabled)
 		enableAutoPowerDown();
 	
@@ -153,214 +319,225 @@ void InstallWindow::executeThread()
 	Application::instance()->exitEnable();
 }
 
-void InstallWindow::InstallProcess(int pos, int total)
+int InstallWindow::InstallProcess(InstallTask * task, int pos, int total)
 {
-	int index = folderList->GetFirstSelected();
+	int index = task->index;
 	
 	std::string title = fmt("安装中... (%d/%d)", pos, total);
-	std::string gameName = folderList->GetName(index);
+	std::string gameName = task->name;
 	
 	messageBox->reload(title, gameName, "", MessageBox::BT_NOBUTTON, MessageBox::IT_ICONINFORMATION, true, "0.0 %");
 	
+	int result = task->result;
+	
+	if(result == InstallBackend::ERROR_ALREADY_INSTALLED)
+	{
+		statsLog->record(task, result, NULL);
+		skippedCount++;
+		folderList->UnSelect(index);
+		
+		//! the countdown replaces the message line, so the reason goes into the title
+		if(pos < total)
+		{
+			messageBox->reload(fmt("已安装 v%u,已跳过", task->manifest.getVersion()), gameName, "目标设备上已有相同或更新的版本", MessageBox::BT_CANCEL, MessageBox::IT_ICONWARNING);
+			messageBox->messageCancelClicked.connect(this, &InstallWindow::OnInstallProcessCancel);
+		}
+		return result;
+	}
+	
 	/////////////////////////////
 	// install process
 	/////////////////////////////
 	
-	int result = 0;
-	installCompleted = 0;
-	installError = 0;
+	int attempt = 0;
+	int action = InstallErrorPolicy::ACTION_CONTINUE;
 	
-	//!---------------------------------------------------
-	//! This part of code originates from Crediars MCP patcher assembly code
-	//! it is just translated to C
-	//!---------------------------------------------------
-	unsigned int mcpHandle = MCP_Open();
-	if(mcpHandle == 0)
+	while(!canceled)
 	{
-		messageBox->reload("安装失败", gameName, "无法打开MCP。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
+		result = task->result;
 		
-		result = -1;
-	}
-	else
-	{
-        char installPath[256];
-		unsigned int * mcpInstallInfo = (unsigned int *)OSAllocFromSystem(0x24, 0x40);
-		char * mcpInstallPath = (char *)OSAllocFromSystem(MAX_INSTALL_PATH_LENGTH, 0x40);
-		IOSVec * mcpPathInfoVector = (IOSVec *)OSAllocFromSystem(0x0C, 0x40);
+		if(result == InstallBackend::INSTALL_OK)
+			result = InstallTitle(task);
+		else
+			statsLog->record(task, result, NULL);
 		
-		do
-		{
-			if(!mcpInstallInfo || !mcpInstallPath || !mcpPathInfoVector)
-			{
-				messageBox->reload("安装失败", gameName, "无法分配内存。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-				result = -2;
-				break;
-			}
-			
-			std::string installFolder = folderList->GetPath(index);
-			installFolder.erase(0, 19);
-			installFolder.insert(0, "/vol/app_sd/");
-            
-            snprintf(installPath, sizeof(installPath), "%s", installFolder.c_str());
-			
-			int res = MCP_InstallGetInfo(mcpHandle, installPath, (MCPInstallInfo*)mcpInstallInfo);
-			if(res != 0)
-			{
-				//__os_snprintf(errorText1, sizeof(errorText1), "Error: MCP_InstallGetInfo 0x%08X", MCP_GetLastRawError());
-				messageBox->reload(installFolder, gameName, "确认文件夹中有完整的WUP文件。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-				result = -3;
-				break;
-			}
-			
-			u32 titleIdHigh = mcpInstallInfo[0];
-			u32 titleIdLow = mcpInstallInfo[1];
-			bool spoofFiles = false;
-			if ((titleIdHigh == 00050010)
-				&&(	   (titleIdLow == 0x10041000)     // JAP Version.bin
-					|| (titleIdLow == 0x10041100)     // USA Version.bin
-					|| (titleIdLow == 0x10041200)))   // EUR Version.bin
-			{
-				spoofFiles = true;
-				target = NAND;
-			}
-			
-			if (spoofFiles
-			   || (titleIdHigh == 0x0005000E)     // game update
-			   || (titleIdHigh == 0x00050000)     // game
-			   || (titleIdHigh == 0x0005000C)     // DLC
-			   || (titleIdHigh == 0x00050002))    // Demo
-			{
-				res = MCP_InstallSetTargetDevice(mcpHandle, (MCPInstallTarget)(target));
-				if(res != 0)
-				{
-					messageBox->reload("安装失败", gameName, fmt("MCP_InstallSetTargetDevice 0x%08X", MCP_GetLastRawError()), MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-					//if (installToUsb)
-					//	__os_snprintf(errorText2, sizeof(errorText2), "Possible USB HDD disconnected or failure");
-					result = -5;
-					break;
-				}
-				res = MCP_InstallSetTargetUsb(mcpHandle, (MCPInstallTarget)(target));
-				if(res != 0)
-				{
-					messageBox->reload("安装失败", gameName, fmt("MCP_InstallSetTargetUsb 0x%08X", MCP_GetLastRawError()), MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-					//if (installToUsb)
-					//	__os_snprintf(errorText2, sizeof(errorText2), "Possible USB HDD disconnected or failure");
-					result = -6;
-					break;
-				}
-				
-				mcpInstallInfo[2] = (unsigned int)MCP_COMMAND_INSTALL_ASYNC;
-				mcpInstallInfo[3] = (unsigned int)mcpPathInfoVector;
-				mcpInstallInfo[4] = (unsigned int)1;
-				mcpInstallInfo[5] = (unsigned int)0;
-				
-				memset(mcpInstallPath, 0, MAX_INSTALL_PATH_LENGTH);
-				snprintf(mcpInstallPath, MAX_INSTALL_PATH_LENGTH, installFolder.c_str());
-				memset(mcpPathInfoVector, 0, 0x0C);
-				
-				mcpPathInfoVector->vaddr = mcpInstallPath;
-				mcpPathInfoVector->len = (unsigned int)MAX_INSTALL_PATH_LENGTH;
-				
-				res = IOS_IoctlvAsync(mcpHandle, MCP_COMMAND_INSTALL_ASYNC, 1, 0, mcpPathInfoVector, (IOSAsyncCallbackFn)IosInstallCallback, mcpInstallInfo);
-				if(res != 0)
-				{
-					messageBox->reload("安装失败", gameName, fmt("MCP_InstallTitleAsync 0x%08X", MCP_GetLastRawError()), MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-					result = -7;
-					break;
-				}
-				
-				while(!installCompleted)
-				{
-					memset(mcpInstallInfo, 0, 0x24);
-					
-					MCP_InstallGetProgress(mcpHandle, (MCPInstallProgress*)mcpInstallInfo);
-					
-					if(mcpInstallInfo[0] == 1)
-					{
-						u64 totalSize = ((u64)mcpInstallInfo[3] << 32ULL) | mcpInstallInfo[4];
-						u64 installedSize = ((u64)mcpInstallInfo[5] << 32ULL) | mcpInstallInfo[6];
-						int percent = (totalSize != 0) ? ((installedSize * 100.0f) / totalSize) : 0;
-						
-						std::string message = fmt("%0.1f / %0.1f MB (%i", installedSize / (1024.0f * 1024.0f), totalSize / (1024.0f * 1024.0f), percent);
-						message += "%)";
-						
-						messageBox->setProgress(percent);
-						messageBox->setProgressBarInfo(message);
-					}
-					
-					usleep(50000);
-				}
-				
-				if(installError != 0)
-				{
-					if ((installError == 0xFFFCFFE9) && (target == USB))
-					{
-						messageBox->reload("安装失败", gameName, fmt("0x%08X无法连接 (没有USB设备?)", installError), MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-						result = -8;
-					}
-					else
-					{
-						//__os_snprintf(errorText1, sizeof(errorText1), "Error: install error code 0x%08X", installError);
-						if (installError == 0xFFFBF446 || installError == 0xFFFBF43F)
-							messageBox->reload("安装失败", gameName, "没有或已损的title.tik文件?", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-						else if (installError == 0xFFFBF441)
-							messageBox->reload("安装失败", gameName, "DLC的title.tik可能不正确。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-						else if (installError == 0xFFFCFFE4)
-							messageBox->reload("安装失败", gameName, "可能选中的设备没有足够内存。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-						else if (installError == 0xFFFFF825)
-							messageBox->reload("安装失败", gameName, "SD卡可能已损坏。重新格式化(簇大小选32k)或更换SD卡。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-						else if ((installError & 0xFFFF0000) == 0xFFFB0000)
-							messageBox->reload("安装失败", gameName, "检查WUP是否正确完整。数字版游戏和DLC需要Sig-Patches。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-						
-						result = -9;
-					}
-				}
-			}
-			else
-			{
-				messageBox->reload("安装失败", gameName, "不是游戏,更新补丁,DLC,试玩版或完整的WUP。", MessageBox::BT_OK, MessageBox::IT_ICONERROR);
-				result = -4;
-			}
-		}
-		while(0);
+		if(result >= 0)
+			break;
 		
-		MCP_Close(mcpHandle);
-		if(mcpPathInfoVector)
-			OSFreeToSystem(mcpPathInfoVector);
-		if(mcpInstallPath)
-			OSFreeToSystem(mcpInstallPath);
-		if(mcpInstallInfo)
-			OSFreeToSystem(mcpInstallInfo);
+		action = errorPolicy.decide(InstallErrorPolicy::classify(result, task->installError), ++attempt);
+		if(action != InstallErrorPolicy::ACTION_RETRY)
+			break;
+		
+		task->retries++;
+		retryCount++;
+		
+		if(!WaitForRetry(task, result, attempt))
+			break;
+		
+		//! an error of the preparation needs the title prepared again
+		if(task->result != InstallBackend::INSTALL_OK)
+			queue->retry(task);
+		
+		messageBox->reload(title, gameName, "", MessageBox::BT_NOBUTTON, MessageBox::IT_ICONINFORMATION, true, "0.0 %");
 	}
 	/////////////////////////////
 	
 	if(result >= 0)
 	{
-		if(pos == total)
-		{
-			messageBox->reload("安装完成", gameName, "", MessageBox::BT_OK, MessageBox::IT_ICONTRUE);
-			messageBox->messageOkClicked.connect(this, &InstallWindow::OnCloseWindow);
-		}
-		else
+		installedCount++;
+		
+		if(pos < total)
 		{
 			messageBox->reload("安装完成", gameName, "6秒后进行下个软件安装", MessageBox::BT_CANCEL, MessageBox::IT_ICONTRUE);
 			messageBox->messageCancelClicked.connect(this, &InstallWindow::OnInstallProcessCancel);
 		}
 		
 		folderList->UnSelect(index);
+		
+		if(task->manifest.isValid())
+			TitleIndex::instance()->add(task->manifest.getTitleId(), task->manifest.getVersion(), task->target);
 	}
-	else
+	else if(action == InstallErrorPolicy::ACTION_SKIP)
+	{
+		//! a failed title does not stop the others
+		failedCount++;
+		
+		std::string failTitle = (result == InstallBackend::ERROR_CONTENT_VERIFY) ? fmt("校验失败,已跳过 (%08X.app)", task->failedContent) : "安装失败,已跳过";
+		
+		if(pos < total)
+		{
+			messageBox->reload(failTitle, gameName, GetErrorText(task, result), MessageBox::BT_CANCEL, MessageBox::IT_ICONWARNING);
+			messageBox->messageCancelClicked.connect(this, &InstallWindow::OnInstallProcessCancel);
+		}
+	}
+	else if(!canceled)
 	{
+		messageBox->reload("安装失败", gameName, GetErrorText(task, result), MessageBox::BT_OK, MessageBox::IT_ICONERROR);
 		messageBox->messageOkClicked.connect(this, &InstallWindow::OnCloseWindow);
 		
 		canceled = true;
 		folderList->UnSelectAll();
 	}
+	
+	return result;
+}
+
+int InstallWindow::InstallTitle(InstallTask * task)
+{
+	task->installStart = OSGetTime();
+	task->installError = 0;
+	task->lastError = 0;
+	
+	int result = backend->start(task);
+	
+	ProgressSampler progressSampler(backend);
+	
+	if(result == InstallBackend::INSTALL_OK)
+	{
+		while(!backend->isCompleted())
+		{
+			int changed = progressSampler.sample(OSTicksToMilliseconds(OSGetTime()));
+			
+			if(changed & ProgressSampler::PERCENT_CHANGED)
+				messageBox->setProgress(progressSampler.getPercent());
+			if(changed & ProgressSampler::INFO_CHANGED)
+				messageBox->setProgressBarInfo(progressSampler.getInfo());
+			
+			TimerService::instance()->sleep(progressSampler.getInterval(), &wakeEvent);
+		}
+		
+		task->installEnd = OSGetTime();
+		
+		u32 installError = backend->getInstallError();
+		if(installError != 0)
+		{
+			task->installError = installError;
+			
+			if ((installError == 0xFFFCFFE9) && (task->target == InstallBackend::USB))
+				result = InstallBackend::ERROR_USB_CONNECTION;
+			else
+				result = InstallBackend::ERROR_INSTALL_FAILED;
+		}
+	}
+	
+	backend->finish();
+	
+	statsLog->record(task, result, &progressSampler);
+	
+	return result;
+}
+
+bool InstallWindow::WaitForRetry(InstallTask * task, int result, int attempt)
+{
+	int time = (errorPolicy.getRetryDelay(attempt) + 999) / 1000;
+	
+	messageBox->reload(fmt("安装失败,%d秒后重试 (%d/%d)", time, attempt, errorPolicy.getMaxRetries()), task->name, GetErrorText(task, result), MessageBox::BT_CANCEL, MessageBox::IT_ICONWARNING);
+	messageBox->messageCancelClicked.connect(this, &InstallWindow::OnInstallProcessCancel);
+	
+	u64 endTime = OSGetTime() + OSMillisecondsToTicks(time * 1000);
+	u64 now = OSGetTime();
+	
+	while(now < endTime && !canceled)
+	{
+		TimerService::instance()->sleep(OSTicksToMilliseconds(endTime - now), &wakeEvent);
+		now = OSGetTime();
+	}
+	
+	messageBox->messageCancelClicked.disconnect(this);
+	
+	return !canceled;
+}
+
+std::string InstallWindow::GetErrorText(InstallTask * task, int result)
+{
+	u32 installError = task->installError;
+	
+	switch(result)
+	{
+		case InstallBackend::ERROR_MCP_OPEN:
+			return "无法打开MCP。";
+		case InstallBackend::ERROR_ALLOC:
+			return "无法分配内存。";
+		case InstallBackend::ERROR_INSTALL_INFO:
+			//__os_snprintf(errorText1, sizeof(errorText1), "Error: MCP_InstallGetInfo 0x%08X", MCP_GetLastRawError());
+			return "确认文件夹中有完整的WUP文件。";
+		case InstallBackend::ERROR_TITLE_TYPE:
+			return "不是游戏,更新补丁,DLC,试玩版或完整的WUP。";
+		case InstallBackend::ERROR_TARGET_DEVICE:
+			//if (installToUsb)
+			//	__os_snprintf(errorText2, sizeof(errorText2), "Possible USB HDD disconnected or failure");
+			return fmt("MCP_InstallSetTargetDevice 0x%08X", task->lastError);
+		case InstallBackend::ERROR_TARGET_USB:
+			return fmt("MCP_InstallSetTargetUsb 0x%08X", task->lastError);
+		case InstallBackend::ERROR_INSTALL_START:
+			return fmt("MCP_InstallTitleAsync 0x%08X", task->lastError);
+		case InstallBackend::ERROR_CONTENT_VERIFY:
+			return fmt("偏移 0x%llX 处数据损坏", task->failedOffset);
+		case InstallBackend::ERROR_USB_CONNECTION:
+			return fmt("0x%08X无法连接 (没有USB设备?)", installError);
+		default:
+			break;
+	}
+	
+	//__os_snprintf(errorText1, sizeof(errorText1), "Error: install error code 0x%08X", installError);
+	if (installError == 0xFFFBF446 || installError == 0xFFFBF43F)
+		return "没有或已损的title.tik文件?";
+	else if (installError == 0xFFFBF441)
+		return "DLC的title.tik可能不正确。";
+	else if (installError == 0xFFFCFFE4)
+		return "可能选中的设备没有足够内存。";
+	else if (installError == 0xFFFFF825)
+		return "SD卡可能已损坏。重新格式化(簇大小选32k)或更换SD卡。";
+	else if ((installError & 0xFFFF0000) == 0xFFFB0000)
+		return "检查WUP是否正确完整。数字版游戏和DLC需要Sig-Patches。";
+	
+	return fmt("安装错误 0x%08X", installError);
 }
 
 void InstallWindow::OnInstallProcessCancel(GuiElement *element, int val)
 {
 	canceled = true;
+	wakeEvent.signal();
 	folderList->UnSelectAll();
 	OnCloseWindow(this, 0);
 }
@@ -2,6 +2,9 @@
 #define INSTALL_WINDOW_H_
 
 #include "fs/CFolderList.hpp"
+#include "install/InstallQueue.h"
+#include "install/InstallErrorPolicy.h"
+#include "install/InstallStatsLog.h"
 #include "gui/MessageBox.h"
 #include "ProgressWindow.h"
 
@@ -23,6 +26,11 @@ public:
 private:
 	void OnValidInstallClick(GuiElement * element, int val);
 	void OnDestinationChoice(GuiElement * element, int choice);
+	void OnSpaceChoice(GuiElement * element, int choice);
+	void OnUnknownSpaceChoice(GuiElement * element, int choice);
+	void OnVerifyChoice(GuiElement * element, int choice);
+	void AskVerify();
+	void OnOrderChoice(GuiElement * element, int choice);
 	void OnCloseWindow(GuiElement * element, int val);
 	void OnWindowClosed(GuiElement * element);
 	void OnInstallProcessCancel(GuiElement *element, int val);
@@ -31,26 +39,39 @@ private:
 	void OnCloseEffectFinish(GuiElement *element);
 	
 	void executeThread();
-	void InstallProcess(int pos, int total);
+	int InstallProcess(InstallTask * task, int pos, int total);
+	int InstallTitle(InstallTask * task);
+	bool WaitForRetry(InstallTask * task, int result, int attempt);
+	std::string GetErrorText(InstallTask * task, int result);
 	
 	GuiFrame * drcFrame;
 	
 	CFolderList * folderList;
 	
+	InstallBackend * backend;
+	InstallQueue * queue;
+	InstallStatsLog * statsLog;
+	InstallErrorPolicy errorPolicy;
+	
 	MessageBox * messageBox;
 	
 	MainWindow * mainWindow;
 	
 	int folderCount;
-	bool canceled;
+	volatile bool canceled;
 	int target;
+	bool verify;
+	//! InstallScheduler::Policy of the queue
+	int orderPolicy;
+	int installedCount;
+	int skippedCount;
+	int failedCount;
+	int retryCount;
+	//! titles that fit into the free space of the target
+	std::vector<int> fittingList;
 	
-	enum
-	{
-		NAND,
-		USB
-	};
-	
+	//! wakes the install thread up from its timer waits
+	CEvent wakeEvent;
 };
 
 #endif
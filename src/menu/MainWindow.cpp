@@ -21,6 +21,7 @@
 #include "utils/StringTools.h"
 #include "common/common.h"
 #include "gui/MessageBox.h"
+#include "install/InstallJournal.h"
 
 MainWindow::MainWindow(int w, int h)
 	: width(w)
@@ -34,7 +35,10 @@ MainWindow::MainWindow(int w, int h)
 	, versionText(WUP_GX2_VERSION)
 {
 	folderList = NULL;
+	browserWindow = NULL;
 	installWindow = NULL;
+	resumePending = false;
+	folderListEmpty = false;
 	
 	for(int i = 0; i < 4; i++)
 	{
@@ -59,6 +63,13 @@ MainWindow::~MainWindow()
 		delete tvElements[0];
 		remove(tvElements[0]);
 	}
+	//! the browser is not in the draw list while the install window is open
+	if(browserWindow != NULL)
+	{
+		currentDrcFrame->remove(browserWindow);
+		delete browserWindow;
+	}
+	
 	while(!drcElements.empty())
 	{
 		delete drcElements[0];
@@ -99,6 +110,12 @@ void MainWindow::updateEffects()
 			tvElements[i]->updateEffects();
 		}
 	}
+	
+	if(folderListEmpty)
+	{
+		folderListEmpty = false;
+		CloseBrowserWindow();
+	}
 }
 
 void MainWindow::update(GuiController *controller)
@@ -181,15 +198,17 @@ void MainWindow::SetupMainView()
 	SetBrowserWindow();
 	SetDrcHeader();
 	
-	if(folderList == NULL)
+	if(InstallJournal().load(resumeList))
 	{
-		MessageBox * messageBox = new MessageBox(MessageBox::BT_OK, MessageBox::IT_ICONERROR, false);
+		MessageBox * messageBox = new MessageBox(MessageBox::BT_YESNO, MessageBox::IT_ICONQUESTION, false);
 		messageBox->setState(GuiElement::STATE_DISABLED);
 		messageBox->setEffect(EFFECT_FADE, 10, 255);
-		messageBox->setTitle("错误:");
-		messageBox->setMessage1("没有找到可安装内容!");
+		messageBox->setTitle("上次的安装没有完成");
+		messageBox->setMessage1(fmt("还有 %d 个软件没有安装", (int)resumeList.size()));
+		messageBox->setMessage2("要继续安装吗?");
 		messageBox->effectFinished.connect(this, &MainWindow::OnOpenEffectFinish);
-		messageBox->messageOkClicked.connect(this, &MainWindow::OnErrorMessageBoxClick);
+		messageBox->messageYesClicked.connect(this, &MainWindow::OnResumeMessageBoxClick);
+		messageBox->messageNoClicked.connect(this, &MainWindow::OnResumeMessageBoxClick);
 		
 		currentDrcFrame->append(messageBox);
 	}
@@ -197,6 +216,78 @@ void MainWindow::SetupMainView()
 	append(currentDrcFrame);
 }
 
+void MainWindow::ShowNoContentError()
+{
+	MessageBox * messageBox = new MessageBox(MessageBox::BT_OK, MessageBox::IT_ICONERROR, false);
+	messageBox->setState(GuiElement::STATE_DISABLED);
+	messageBox->setEffect(EFFECT_FADE, 10, 255);
+	messageBox->setTitle("错误:");
+	messageBox->setMessage1("没有找到可安装内容!");
+	messageBox->effectFinished.connect(this, &MainWindow::OnOpenEffectFinish);
+	messageBox->messageOkClicked.connect(this, &MainWindow::OnErrorMessageBoxClick);
+	
+	currentDrcFrame->append(messageBox);
+}
+
+void MainWindow::OnResumeMessageBoxClick(GuiElement *element, int choice)
+{
+	currentDrcFrame->remove(element);
+	AsyncDeleter::pushForDelete(element);
+	
+	if(choice != MessageBox::MR_YES || !browserWindow)
+	{
+		InstallJournal().discard();
+		return;
+	}
+	
+	//! the titles of the batch might not all be found yet
+	if(browserWindow->isScanning())
+	{
+		resumePending = true;
+		return;
+	}
+	
+	ResumeBatch();
+}
+
+void MainWindow::OnScanFinished(GuiElement *element)
+{
+	if(!resumePending)
+		return;
+	
+	resumePending = false;
+	ResumeBatch();
+}
+
+void MainWindow::ResumeBatch()
+{
+	//! select what is left of the batch in its install order
+	folderList->UnSelectAll();
+	
+	for(u32 n = 0; n < resumeList.size(); n++)
+	{
+		for(int i = 0; i < folderList->GetCount(); i++)
+		{
+			if(folderList->GetPath(i) == resumeList[n])
+			{
+				folderList->Select(i);
+				break;
+			}
+		}
+	}
+	
+	resumeList.clear();
+	
+	//! none of the titles is on the card anymore, the journal would ask again on every launch
+	if(folderList->GetSelectedCount() == 0)
+	{
+		InstallJournal().discard();
+		return;
+	}
+	
+	OnInstallButtonClicked(browserWindow);
+}
+
 void MainWindow::SetDrcHeader()
 {
 	titleText.setColor(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
@@ -222,25 +313,42 @@ void MainWindow::SetDrcHeader()
 
 void MainWindow::SetBrowserWindow()
 {
-	browserWindow = NULL;
-	
+	//! the browser shows the folders while the scan is still finding them
 	if(folderList == NULL)
 	{
 		folderList = new CFolderList();
-		folderList->Get();
-	}
-	
-	if(!folderList->GetCount())
-	{
-		delete folderList;
-		folderList = NULL;
-		return;
+		folderList->StartScan();
 	}
 	
 	browserWindow = new BrowserWindow(920, height, folderList);
 	browserWindow->setAlignment(ALIGN_LEFT | ALIGN_MIDDLE);
 	browserWindow->setPosition(50, 0);
 	browserWindow->installButtonClicked.connect(this, &MainWindow::OnInstallButtonClicked);
+	browserWindow->folderListEmpty.connect(this, &MainWindow::OnFolderListEmpty);
+	browserWindow->scanFinished.connect(this, &MainWindow::OnScanFinished);
+	ShowBrowserWindow();
+}
+
+void MainWindow::OnFolderListEmpty(GuiElement *element)
+{
+	//! the signal comes from the update of the browser, it can not be deleted here
+	folderListEmpty = true;
+}
+
+void MainWindow::CloseBrowserWindow()
+{
+	currentDrcFrame->remove(browserWindow);
+	AsyncDeleter::pushForDelete(browserWindow);
+	browserWindow = NULL;
+	
+	delete folderList;
+	folderList = NULL;
+	
+	ShowNoContentError();
+}
+
+void MainWindow::ShowBrowserWindow()
+{
 	browserWindow->setState(GuiElement::STATE_DISABLED);
 	browserWindow->setEffect(EFFECT_FADE, 10, 255);
 	browserWindow->effectFinished.connect(this, &MainWindow::OnOpenEffectFinish);
@@ -253,19 +361,40 @@ void MainWindow::OnInstallButtonClicked(GuiElement *element)
 	browserWindow->setState(GuiElement::STATE_DISABLED);
 	browserWindow->effectFinished.connect(this, &MainWindow::OnBrowserCloseEffectFinish);
 	
+	//! the verification and MCP need the sd card, the refresh after the install sums up the sizes again
+	folderList->StopSizes();
+	
 	installWindow = new InstallWindow(folderList);
 	installWindow->installWindowClosed.connect(this, &MainWindow::OnInstallWindowClosed);
 }
 
 void MainWindow::OnBrowserCloseEffectFinish(GuiElement *element)
 {
-	//! remove element from draw list and push to delete queue
+	//! only remove it from the draw list, the rows are reused after the install
+	element->effectFinished.disconnect(this);
 	currentDrcFrame->remove(element);
-	AsyncDeleter::pushForDelete(element);
 }
+
 void MainWindow::OnInstallWindowClosed(GuiElement *element)
 {
-	SetBrowserWindow();
+	//! the scan index makes the rescan cheap, only changed rows are rebuilt
+	CFolderList::Changes changes;
+	folderList->Refresh(changes);
+	
+	if(!folderList->GetCount())
+	{
+		AsyncDeleter::pushForDelete(browserWindow);
+		browserWindow = NULL;
+		
+		delete folderList;
+		folderList = NULL;
+		
+		ShowNoContentError();
+		return;
+	}
+	
+	browserWindow->Refresh(changes);
+	ShowBrowserWindow();
 	currentDrcFrame->bringToFront(&headerFrame);
 }
 
@@ -132,11 +132,18 @@ private:
     void SetupMainView(void);
 	void SetDrcHeader(void);
 	void SetBrowserWindow(void);
+	void ShowBrowserWindow(void);
+	void ShowNoContentError(void);
 	
 	void OnInstallButtonClicked(GuiElement *element);
 	void OnBrowserCloseEffectFinish(GuiElement *element);
 	void OnInstallWindowClosed(GuiElement *element);
+	void OnFolderListEmpty(GuiElement *element);
 	void OnErrorMessageBoxClick(GuiElement *element, int ok);
+	void OnResumeMessageBoxClick(GuiElement *element, int choice);
+	void OnScanFinished(GuiElement *element);
+	void ResumeBatch(void);
+	void CloseBrowserWindow(void);
 	void OnOpenEffectFinish(GuiElement *element);
 	void OnCloseEffectFinish(GuiElement *element);
 	
@@ -164,6 +171,13 @@ private:
 	CFolderList * folderList;
     BrowserWindow * browserWindow;
 	InstallWindow * installWindow;
+	
+	//! titles of an interrupted batch
+	std::vector<std::string> resumeList;
+	//! the batch is resumed once the scan found all titles
+	bool resumePending;
+	//! the browser is closed after its own update returned
+	bool folderListEmpty;
 
     CMutex guiMutex;
 };
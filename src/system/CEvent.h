@@ -0,0 +1,49 @@
+#ifndef _CEVENT_H_
+#define _CEVENT_H_
+
+#include <malloc.h>
+#include <coreinit/event.h>
+#include "common/types.h"
+
+class CEvent
+{
+public:
+    //! an auto reset event wakes exactly one waiter per signal
+    //! a manual reset event stays signaled until reset() is called
+    CEvent(bool autoReset = true) {
+        pEvent = (OSEvent*) malloc(sizeof(OSEvent));
+        if(!pEvent)
+            return;
+
+        OSInitEvent(pEvent, FALSE, autoReset ? OS_EVENT_MODE_AUTO : OS_EVENT_MODE_MANUAL);
+    }
+    virtual ~CEvent() {
+        if(pEvent)
+            free(pEvent);
+    }
+
+    void signal(void) {
+        if(pEvent)
+            OSSignalEvent(pEvent);
+    }
+    void reset(void) {
+        if(pEvent)
+            OSResetEvent(pEvent);
+    }
+    void wait(void) {
+        if(pEvent)
+            OSWaitEvent(pEvent);
+    }
+    //! returns false if the timeout elapsed before the event was signaled
+    bool waitTimeout(u32 milliseconds) {
+        if(!pEvent)
+            return false;
+
+        //! the timeout is given in nanoseconds
+        return (OSWaitEventWithTimeout(pEvent, (OSTime)milliseconds * 1000000ULL) != FALSE);
+    }
+private:
+    OSEvent *pEvent;
+};
+
+#endif // _CEVENT_H_
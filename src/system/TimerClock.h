@@ -0,0 +1,16 @@
+#ifndef _TIMER_CLOCK_H_
+#define _TIMER_CLOCK_H_
+
+#include "common/types.h"
+
+//! Where the timers get the current time from. The console uses the OS
+//! clock, the host tests move a clock of their own by hand.
+class TimerClock
+{
+public:
+	virtual ~TimerClock() {}
+
+	virtual u64 getTimeMs() const = 0;
+};
+
+#endif // _TIMER_CLOCK_H_
@@ -0,0 +1,92 @@
+#include "TimerService.h"
+
+TimerService * TimerService::timerInstance = NULL;
+
+TimerService::TimerService()
+    : CThread(CThread::eAttributeAffCore1 | CThread::eAttributePinnedAff)
+    , exitRequested(false)
+    , wheel(osClock)
+{
+}
+
+TimerService::~TimerService()
+{
+    exitRequested = true;
+    wakeEvent.signal();
+    shutdownThread();
+}
+
+u32 TimerService::addTimer(u32 delayMs, u32 periodMs, const TimerWheel::Callback & callback)
+{
+    timerMutex.lock();
+    u32 id = wheel.add(delayMs, periodMs, callback);
+    timerMutex.unlock();
+
+    //! let the thread recalculate its sleep time
+    wakeEvent.signal();
+
+    return id;
+}
+
+bool TimerService::removeTimer(u32 id)
+{
+    //! wait for callbacks which are currently executed
+    callbackMutex.lock();
+    timerMutex.lock();
+    bool removed = wheel.remove(id);
+    timerMutex.unlock();
+    callbackMutex.unlock();
+
+    return removed;
+}
+
+bool TimerService::sleep(u32 milliseconds, CEvent * event)
+{
+    if(!event)
+        return false;
+
+    volatile bool elapsed = false;
+
+    u32 id = addTimer(milliseconds, 0, [&]() {
+        elapsed = true;
+        event->signal();
+    });
+
+    event->wait();
+    removeTimer(id);
+
+    return elapsed;
+}
+
+void TimerService::executeThread(void)
+{
+    std::vector<TimerWheel::Callback> fired;
+
+    while(!exitRequested)
+    {
+        timerMutex.lock();
+        u32 waitMs = wheel.timeUntilNext();
+        timerMutex.unlock();
+
+        if(waitMs == (u32) -1)
+            wakeEvent.wait();
+        else if(waitMs > 0)
+            wakeEvent.waitTimeout(waitMs);
+
+        if(exitRequested)
+            break;
+
+        callbackMutex.lock();
+
+        timerMutex.lock();
+        wheel.advance(fired);
+        timerMutex.unlock();
+
+        for(u32 i = 0; i < fired.size(); i++)
+            fired[i]();
+
+        callbackMutex.unlock();
+
+        fired.clear();
+    }
+}
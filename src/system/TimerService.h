@@ -0,0 +1,76 @@
+#ifndef _TIMER_SERVICE_H_
+#define _TIMER_SERVICE_H_
+
+#include <vector>
+#include <coreinit/time.h>
+#include "CThread.h"
+#include "CMutex.h"
+#include "CEvent.h"
+#include "TimerWheel.h"
+
+class OSTimerClock : public TimerClock
+{
+public:
+    u64 getTimeMs() const { return OSTicksToMilliseconds(OSGetTime()); }
+};
+
+//! Runs one-shot and periodic timers on a thread that sleeps until the next
+//! timer is due. Other threads can use it to wait without burning a core.
+class TimerService : public CThread
+{
+public:
+    static TimerService * instance()
+    {
+        if(!timerInstance)
+        {
+            timerInstance = new TimerService;
+            timerInstance->resumeThread();
+        }
+        return timerInstance;
+    }
+
+    static void destroyInstance()
+    {
+        delete timerInstance;
+        timerInstance = NULL;
+    }
+
+    //! Callbacks run on the timer thread and should return quickly
+    u32 addTimer(u32 delayMs, u32 periodMs, const TimerWheel::Callback & callback);
+    //! Once this returns the callback of the timer is guaranteed to not run anymore
+    bool removeTimer(u32 id);
+
+    //! Blocks the calling thread for milliseconds. Signaling event from another
+    //! thread wakes it up early. Returns true if the full time elapsed.
+    bool sleep(u32 milliseconds, CEvent * event);
+
+private:
+    TimerService();
+    virtual ~TimerService();
+
+    void executeThread(void);
+
+    static TimerService *timerInstance;
+
+    volatile bool exitRequested;
+    OSTimerClock osClock;
+    TimerWheel wheel;
+    CMutex timerMutex;
+    CMutex callbackMutex;
+    CEvent wakeEvent;
+};
+
+//! Removes a timer when the scope is left, a callback that uses locals
+//! of the scope can not run anymore once they are gone
+class TimerGuard
+{
+public:
+    TimerGuard(u32 timerId) : id(timerId) {}
+    virtual ~TimerGuard() {
+        TimerService::instance()->removeTimer(id);
+    }
+private:
+    u32 id;
+};
+
+#endif // _TIMER_SERVICE_H_
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(const TimerClock & timerClock, u32 tick, u32 slotCount)
+	: clock(timerClock)
+	, tickMs(tick ? tick : 1)
+	, currentTick(0)
+	, started(false)
+	, nextId(1)
+	, timerCount(0)
+	, slots(slotCount ? slotCount : 1)
+	, nextExpiry((u64) -1)
+	, nextExpiryValid(true)
+{
+}
+
+void TimerWheel::start(u64 nowMs)
+{
+	if(started)
+		return;
+
+	currentTick = nowMs / tickMs;
+	started = true;
+}
+
+bool TimerWheel::compareExpiry(const Timer & a, const Timer & b)
+{
+	if(a.expires != b.expires)
+		return a.expires < b.expires;
+
+	//! timers with the same expiry fire in the order they were added
+	return a.id < b.id;
+}
+
+void TimerWheel::insert(const Timer & timer)
+{
+	u32 slot = (timer.expires / tickMs) % slots.size();
+	slots[slot].push_back(timer);
+	timerSlots[timer.id] = slot;
+	timerCount++;
+
+	if(nextExpiryValid && timer.expires < nextExpiry)
+		nextExpiry = timer.expires;
+}
+
+void TimerWheel::updateNextExpiry() const
+{
+	nextExpiry = (u64) -1;
+	nextExpiryValid = true;
+
+	if(timerCount == 0)
+		return;
+
+	for(u32 i = 0; i < slots.size(); i++)
+	{
+		const std::vector<Timer> & slot = slots[i];
+
+		for(u32 n = 0; n < slot.size(); n++)
+		{
+			if(slot[n].expires < nextExpiry)
+				nextExpiry = slot[n].expires;
+		}
+	}
+}
+
+u32 TimerWheel::add(u32 delayMs, u32 periodMs, const Callback & callback)
+{
+	u64 nowMs = clock.getTimeMs();
+	start(nowMs);
+
+	Timer timer;
+	timer.id = nextId++;
+	timer.expires = nowMs + delayMs;
+	timer.period = periodMs;
+	timer.callback = callback;
+
+	//! id 0 is reserved as invalid
+	if(nextId == 0)
+		nextId = 1;
+
+	insert(timer);
+
+	return timer.id;
+}
+
+bool TimerWheel::remove(u32 id)
+{
+	std::unordered_map<u32, u32>::iterator itr = timerSlots.find(id);
+	if(itr == timerSlots.end())
+		return false;
+
+	std::vector<Timer> & slot = slots[itr->second];
+	timerSlots.erase(itr);
+
+	for(u32 n = 0; n < slot.size(); n++)
+	{
+		if(slot[n].id == id)
+		{
+			if(slot[n].expires == nextExpiry)
+				nextExpiryValid = false;
+
+			slot.erase(slot.begin() + n);
+			timerCount--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int TimerWheel::advance(std::vector<Callback> & fired)
+{
+	u64 nowMs = clock.getTimeMs();
+	start(nowMs);
+
+	u64 nowTick = nowMs / tickMs;
+	if(nowTick < currentTick)
+		return 0;
+
+	//! every slot is visited at most once per call, expired timers are
+	//! recognized by their absolute time so no tick gets lost on long sleeps
+	u64 ticks = nowTick - currentTick + 1;
+	if(ticks > slots.size())
+		ticks = slots.size();
+
+	std::vector<Timer> expired;
+
+	for(u64 t = 0; t < ticks; t++)
+	{
+		std::vector<Timer> & slot = slots[(currentTick + t) % slots.size()];
+
+		for(u32 n = 0; n < slot.size(); )
+		{
+			if(slot[n].expires <= nowMs)
+			{
+				expired.push_back(slot[n]);
+				timerSlots.erase(slot[n].id);
+				slot.erase(slot.begin() + n);
+				timerCount--;
+			}
+			else
+			{
+				n++;
+			}
+		}
+	}
+
+	currentTick = nowTick;
+
+	//! a slot holds the timers of every wheel turn and a long sleep visits
+	//! the slots starting in the middle, neither is ordered by expiry
+	std::sort(expired.begin(), expired.end(), compareExpiry);
+
+	//! the earliest timer is among the expired ones
+	if(!expired.empty())
+		nextExpiryValid = false;
+
+	for(u32 i = 0; i < expired.size(); i++)
+	{
+		fired.push_back(expired[i].callback);
+
+		if(expired[i].period)
+		{
+			Timer & timer = expired[i];
+			timer.expires += timer.period;
+
+			//! do not try to catch up on missed periods
+			if(timer.expires <= nowMs)
+				timer.expires = nowMs + timer.period;
+
+			insert(timer);
+		}
+	}
+
+	return expired.size();
+}
+
+u32 TimerWheel::timeUntilNext() const
+{
+	u64 nowMs = clock.getTimeMs();
+
+	if(!nextExpiryValid)
+		updateNextExpiry();
+
+	u64 next = nextExpiry;
+
+	if(next == (u64) -1)
+		return (u32) -1;
+
+	if(next <= nowMs)
+		return 0;
+
+	u64 diff = next - nowMs;
+	if(diff >= (u32) -1)
+		return (u32) -2;
+
+	return (u32) diff;
+}
@@ -0,0 +1,64 @@
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "common/types.h"
+#include "TimerClock.h"
+
+//! Hashed timer wheel. It does not know about threads, the owner locks it.
+//! The time comes from the clock it is created with.
+class TimerWheel
+{
+public:
+	typedef std::function<void()> Callback;
+
+	TimerWheel(const TimerClock & clock, u32 tickMs = 10, u32 slotCount = 256);
+	virtual ~TimerWheel() {}
+
+	//! Adds a timer that fires after delayMs and then every periodMs (0 = one-shot)
+	//! Returns the timer id which is never 0
+	u32 add(u32 delayMs, u32 periodMs, const Callback & callback);
+	//! Removes a pending timer, returns false if it already fired or does not exist
+	bool remove(u32 id);
+	//! Collects the callbacks of every timer that expired by now into fired,
+	//! ordered by their expiry time. Periodic timers are rescheduled. The callbacks
+	//! are not run here so the owner can run them without holding its lock.
+	int advance(std::vector<Callback> & fired);
+	//! Milliseconds until the next timer expires, ~0 if no timer is pending
+	u32 timeUntilNext() const;
+
+	bool empty() const { return timerCount == 0; }
+	u32 count() const { return timerCount; }
+
+private:
+	typedef struct
+	{
+		u32 id;
+		u64 expires;
+		u32 period;
+		Callback callback;
+	} Timer;
+
+	static bool compareExpiry(const Timer & a, const Timer & b);
+
+	void insert(const Timer & timer);
+	void start(u64 nowMs);
+	void updateNextExpiry() const;
+
+	const TimerClock & clock;
+	u32 tickMs;
+	u64 currentTick;
+	bool started;
+	u32 nextId;
+	u32 timerCount;
+	std::vector< std::vector<Timer> > slots;
+	//! slot of every pending timer so remove() does not search the wheel
+	std::unordered_map<u32, u32> timerSlots;
+	//! earliest expiry of all timers, only rescanned once that timer is gone
+	mutable u64 nextExpiry;
+	mutable bool nextExpiryValid;
+};
+
+#endif // _TIMER_WHEEL_H_
@@ -174,7 +174,7 @@ int strextcmp(const char * string, const char * extension, char seperator)
 	if(!string || !extension)
 		return -1;
 
-	char *ptr = strrchr(string, seperator);
+	const char *ptr = strrchr(string, seperator);
 	if(!ptr)
 		return -1;
 
@@ -0,0 +1,27 @@
+#ifndef __AES_H_
+#define __AES_H_
+
+#include "common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AES_BLOCK_SIZE      16
+
+typedef struct
+{
+    u8 roundKeys[176];
+} AESContext;
+
+//! AES-128, the installer only decrypts, the host tests encrypt their contents
+void aes_set_key(AESContext *ctx, const u8 key[16]);
+//! iv is updated so consecutive calls continue the CBC chain, size must be a multiple of 16
+void aes_cbc_decrypt(const AESContext *ctx, u8 iv[16], const u8 *in, u8 *out, u32 size);
+void aes_cbc_encrypt(const AESContext *ctx, u8 iv[16], const u8 *in, u8 *out, u32 size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __AES_H_
@@ -0,0 +1,133 @@
+#include <string.h>
+#include "sha1.h"
+
+#define ROL(x, n)   (((x) << (n)) | ((x) >> (32 - (n))))
+
+static void sha1_transform(u32 state[5], const u8 *block)
+{
+    u32 w[80];
+    u32 a, b, c, d, e, t;
+    int i;
+
+    for(i = 0; i < 16; i++)
+        w[i] = ((u32)block[i*4] << 24) | ((u32)block[i*4+1] << 16) | ((u32)block[i*4+2] << 8) | block[i*4+3];
+
+    for(i = 16; i < 80; i++)
+        w[i] = ROL(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
+    e = state[4];
+
+    for(i = 0; i < 80; i++)
+    {
+        if(i < 20)
+            t = ((b & c) | (~b & d)) + 0x5A827999;
+        else if(i < 40)
+            t = (b ^ c ^ d) + 0x6ED9EBA1;
+        else if(i < 60)
+            t = ((b & c) | (b & d) | (c & d)) + 0x8F1BBCDC;
+        else
+            t = (b ^ c ^ d) + 0xCA62C1D6;
+
+        t += ROL(a, 5) + e + w[i];
+        e = d;
+        d = c;
+        c = ROL(b, 30);
+        b = a;
+        a = t;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+void sha1_init(SHA1Context *ctx)
+{
+    ctx->state[0] = 0x67452301;
+    ctx->state[1] = 0xEFCDAB89;
+    ctx->state[2] = 0x98BADCFE;
+    ctx->state[3] = 0x10325476;
+    ctx->state[4] = 0xC3D2E1F0;
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+void sha1_update(SHA1Context *ctx, const void *data, u32 size)
+{
+    const u8 *ptr = (const u8 *) data;
+
+    ctx->length += size;
+
+    if(ctx->used)
+    {
+        u32 fill = 64 - ctx->used;
+        if(fill > size)
+            fill = size;
+
+        memcpy(ctx->buffer + ctx->used, ptr, fill);
+        ctx->used += fill;
+        ptr += fill;
+        size -= fill;
+
+        if(ctx->used < 64)
+            return;
+
+        sha1_transform(ctx->state, ctx->buffer);
+        ctx->used = 0;
+    }
+
+    //! full blocks are hashed straight from the input
+    while(size >= 64)
+    {
+        sha1_transform(ctx->state, ptr);
+        ptr += 64;
+        size -= 64;
+    }
+
+    if(size)
+    {
+        memcpy(ctx->buffer, ptr, size);
+        ctx->used = size;
+    }
+}
+
+void sha1_final(SHA1Context *ctx, u8 digest[SHA1_DIGEST_SIZE])
+{
+    u64 bits = ctx->length * 8;
+    u8 pad[72];
+    u32 padSize = (ctx->used < 56) ? (56 - ctx->used) : (120 - ctx->used);
+    int i;
+
+    memset(pad, 0, sizeof(pad));
+    pad[0] = 0x80;
+
+    for(i = 0; i < 8; i++)
+        pad[padSize + i] = (u8)(bits >> (56 - i * 8));
+
+    //! the length must not be counted again
+    u64 length = ctx->length;
+    sha1_update(ctx, pad, padSize + 8);
+    ctx->length = length;
+
+    for(i = 0; i < 5; i++)
+    {
+        digest[i*4] = (u8)(ctx->state[i] >> 24);
+        digest[i*4+1] = (u8)(ctx->state[i] >> 16);
+        digest[i*4+2] = (u8)(ctx->state[i] >> 8);
+        digest[i*4+3] = (u8)ctx->state[i];
+    }
+}
+
+void sha1(const void *data, u32 size, u8 digest[SHA1_DIGEST_SIZE])
+{
+    SHA1Context ctx;
+    sha1_init(&ctx);
+    sha1_update(&ctx, data, size);
+    sha1_final(&ctx, digest);
+}
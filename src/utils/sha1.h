@@ -0,0 +1,29 @@
+#ifndef __SHA1_H_
+#define __SHA1_H_
+
+#include "common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHA1_DIGEST_SIZE    20
+
+typedef struct
+{
+    u32 state[5];
+    u64 length;
+    u8 buffer[64];
+    u32 used;
+} SHA1Context;
+
+void sha1_init(SHA1Context *ctx);
+void sha1_update(SHA1Context *ctx, const void *data, u32 size);
+void sha1_final(SHA1Context *ctx, u8 digest[SHA1_DIGEST_SIZE]);
+void sha1(const void *data, u32 size, u8 digest[SHA1_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHA1_H_
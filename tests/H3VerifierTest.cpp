@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "fs/H3Verifier.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+static const u8 testKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+//! A hashed content laid out like the ones of a real title: every 64 KiB
+//! block starts with the H0, H1 and H2 tables of its groups, the first H0
+//! hash of every 16 blocks has the low byte of the content index in byte 1
+//! and the data iv is that hash with the index taken out again.
+class HashedContent
+{
+public:
+	HashedContent(u32 blockCount, u16 index, bool encrypt)
+	{
+		const u32 dataSize = H3Verifier::DATA_SIZE;
+		const u32 groups = (blockCount + 15) / 16;
+		const u32 groups1 = (groups + 15) / 16;
+		const u32 groups2 = (groups1 + 15) / 16;
+
+		std::vector<u8> plain((u64)blockCount * dataSize);
+		for(u32 i = 0; i < plain.size(); i++)
+			plain[i] = (u8)((i * 2654435761u) >> 13);
+
+		//! hash tables of blocks behind the end of the content stay zero
+		std::vector<u8> h0((u64)groups * 16 * SHA1_DIGEST_SIZE, 0);
+		std::vector<u8> h1((u64)groups1 * 16 * SHA1_DIGEST_SIZE, 0);
+		std::vector<u8> h2((u64)groups2 * 16 * SHA1_DIGEST_SIZE, 0);
+		h3.assign(groups2 * SHA1_DIGEST_SIZE, 0);
+
+		for(u32 b = 0; b < blockCount; b++)
+		{
+			u8 * hash = &h0[b * SHA1_DIGEST_SIZE];
+			sha1(&plain[(u64)b * dataSize], dataSize, hash);
+			if(b % 16 == 0)
+				hash[1] ^= (u8)index;
+		}
+		for(u32 g = 0; g < groups; g++)
+			sha1(&h0[g * 16 * SHA1_DIGEST_SIZE], 16 * SHA1_DIGEST_SIZE, &h1[g * SHA1_DIGEST_SIZE]);
+		for(u32 g = 0; g < groups1; g++)
+			sha1(&h1[g * 16 * SHA1_DIGEST_SIZE], 16 * SHA1_DIGEST_SIZE, &h2[g * SHA1_DIGEST_SIZE]);
+		for(u32 g = 0; g < groups2; g++)
+			sha1(&h2[g * 16 * SHA1_DIGEST_SIZE], 16 * SHA1_DIGEST_SIZE, &h3[g * SHA1_DIGEST_SIZE]);
+
+		AESContext key;
+		aes_set_key(&key, testKey);
+
+		data.assign((u64)blockCount * H3Verifier::BLOCK_SIZE, 0);
+
+		for(u32 b = 0; b < blockCount; b++)
+		{
+			u8 * block = &data[(u64)b * H3Verifier::BLOCK_SIZE];
+			memcpy(block + H3Verifier::H0_OFFSET, &h0[(b / 16) * 16 * SHA1_DIGEST_SIZE], 16 * SHA1_DIGEST_SIZE);
+			memcpy(block + H3Verifier::H1_OFFSET, &h1[(b / 256) * 16 * SHA1_DIGEST_SIZE], 16 * SHA1_DIGEST_SIZE);
+			memcpy(block + H3Verifier::H2_OFFSET, &h2[(b / 4096) * 16 * SHA1_DIGEST_SIZE], 16 * SHA1_DIGEST_SIZE);
+			memcpy(block + H3Verifier::HASH_HEADER_SIZE, &plain[(u64)b * dataSize], dataSize);
+
+			if(!encrypt)
+				continue;
+
+			u8 iv[16];
+			memcpy(iv, block + H3Verifier::H0_OFFSET + (b % 16) * SHA1_DIGEST_SIZE, sizeof(iv));
+			if(b % 16 == 0)
+				iv[1] ^= (u8)index;
+			aes_cbc_encrypt(&key, iv, block + H3Verifier::HASH_HEADER_SIZE, block + H3Verifier::HASH_HEADER_SIZE, dataSize);
+
+			memset(iv, 0, sizeof(iv));
+			aes_cbc_encrypt(&key, iv, block, block, H3Verifier::HASH_HEADER_SIZE);
+		}
+	}
+
+	std::vector<u8> data;
+	std::vector<u8> h3;
+};
+
+//! feeds the content in chunks that do not line up with the blocks
+static int verify(const HashedContent & content, u16 index, bool encrypted, u64 & failedOffset)
+{
+	AESContext key;
+	aes_set_key(&key, testKey);
+
+	H3Verifier tree;
+	if(!tree.init(&content.h3[0], content.h3.size(), content.data.size(), encrypted ? &key : NULL, index))
+		return H3Verifier::H3_ERROR_INIT;
+
+	const u32 chunk = 100000;
+	int result = H3Verifier::H3_OK;
+
+	for(u64 pos = 0; pos < content.data.size() && result == H3Verifier::H3_OK; pos += chunk)
+	{
+		u32 size = (content.data.size() - pos < chunk) ? (u32)(content.data.size() - pos) : chunk;
+		result = tree.update(&content.data[pos], size);
+	}
+
+	if(result == H3Verifier::H3_OK)
+		result = tree.finish();
+
+	failedOffset = tree.getFailedOffset();
+	return result;
+}
+
+static void testContentIndex()
+{
+	u64 offset = 0;
+
+	//! content 0 is the only one the index does not change
+	HashedContent first(20, 0, true);
+	CHECK(verify(first, 0, true, offset) == H3Verifier::H3_OK);
+
+	//! more than one group of 16 so the index shows up in block 0 and 16
+	HashedContent content(40, 5, true);
+	CHECK(verify(content, 5, true, offset) == H3Verifier::H3_OK);
+
+	//! a wrong index breaks the first block of the content
+	CHECK(verify(content, 0, true, offset) == H3Verifier::H3_ERROR_H0);
+	CHECK(offset == 0);
+
+	//! only the low byte of the index is used
+	HashedContent large(17, 0x1A3, true);
+	CHECK(verify(large, 0x1A3, true, offset) == H3Verifier::H3_OK);
+
+	//! decrypted contents carry the index in the hash as well
+	HashedContent plain(18, 7, false);
+	CHECK(verify(plain, 7, false, offset) == H3Verifier::H3_OK);
+	CHECK(verify(plain, 0, false, offset) == H3Verifier::H3_ERROR_H0);
+}
+
+static void testBrokenContent()
+{
+	u64 offset = 0;
+
+	HashedContent content(40, 3, true);
+	content.data[17 * H3Verifier::BLOCK_SIZE + 0x2000] ^= 0x01;
+	CHECK(verify(content, 3, true, offset) == H3Verifier::H3_ERROR_H0);
+	CHECK(offset == 17 * H3Verifier::BLOCK_SIZE);
+
+	HashedContent tree(40, 3, true);
+	tree.h3[0] ^= 0x80;
+	CHECK(verify(tree, 3, true, offset) == H3Verifier::H3_ERROR_H3);
+	CHECK(offset == 0);
+
+	HashedContent shortContent(20, 3, true);
+	shortContent.data.resize(shortContent.data.size() - 0x100);
+	CHECK(verify(shortContent, 3, true, offset) == H3Verifier::H3_ERROR_SIZE);
+}
+
+int main()
+{
+	testContentIndex();
+	testBrokenContent();
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include "install/InstallErrorPolicy.h"
+#include "install/InstallBackend.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+static void testClassify()
+{
+	CHECK(InstallErrorPolicy::classify(InstallBackend::INSTALL_OK, 0) == InstallErrorPolicy::ERROR_CLASS_NONE);
+
+	const int transient[] = { InstallBackend::ERROR_MCP_OPEN, InstallBackend::ERROR_ALLOC, InstallBackend::ERROR_TARGET_DEVICE,
+	                          InstallBackend::ERROR_TARGET_USB, InstallBackend::ERROR_INSTALL_START, InstallBackend::ERROR_USB_CONNECTION };
+	for(u32 i = 0; i < sizeof(transient) / sizeof(transient[0]); i++)
+		CHECK(InstallErrorPolicy::classify(transient[i], 0) == InstallErrorPolicy::ERROR_CLASS_TRANSIENT);
+
+	const int content[] = { InstallBackend::ERROR_INSTALL_INFO, InstallBackend::ERROR_TITLE_TYPE, InstallBackend::ERROR_CONTENT_VERIFY };
+	for(u32 i = 0; i < sizeof(content) / sizeof(content[0]); i++)
+		CHECK(InstallErrorPolicy::classify(content[i], 0) == InstallErrorPolicy::ERROR_CLASS_CONTENT);
+
+	//! a failed install is classified by the error MCP reported
+	const int failed = InstallBackend::ERROR_INSTALL_FAILED;
+	CHECK(InstallErrorPolicy::classify(failed, 0xFFFCFFE9) == InstallErrorPolicy::ERROR_CLASS_TRANSIENT);
+	CHECK(InstallErrorPolicy::classify(failed, 0xFFFFF825) == InstallErrorPolicy::ERROR_CLASS_TRANSIENT);
+	CHECK(InstallErrorPolicy::classify(failed, 0xFFFCFFE4) == InstallErrorPolicy::ERROR_CLASS_SPACE);
+	CHECK(InstallErrorPolicy::classify(failed, 0xFFFBF446) == InstallErrorPolicy::ERROR_CLASS_CONTENT);
+	CHECK(InstallErrorPolicy::classify(failed, 0xFFFBF43F) == InstallErrorPolicy::ERROR_CLASS_CONTENT);
+	CHECK(InstallErrorPolicy::classify(failed, 0xFFFBF441) == InstallErrorPolicy::ERROR_CLASS_CONTENT);
+	CHECK(InstallErrorPolicy::classify(failed, 0xFFFB0001) == InstallErrorPolicy::ERROR_CLASS_PERMISSION);
+	CHECK(InstallErrorPolicy::classify(failed, 0x12345678) == InstallErrorPolicy::ERROR_CLASS_CONTENT);
+
+	//! results the policy does not know are not retried
+	CHECK(InstallErrorPolicy::classify(-100, 0) == InstallErrorPolicy::ERROR_CLASS_CONTENT);
+}
+
+static void testTransientRetries()
+{
+	InstallErrorPolicy policy;
+
+	for(int attempt = 1; attempt <= 3; attempt++)
+		CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_TRANSIENT, attempt) == InstallErrorPolicy::ACTION_RETRY);
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_TRANSIENT, 4) == InstallErrorPolicy::ACTION_SKIP);
+
+	CHECK(policy.getRetryDelay(1) == 5000);
+	CHECK(policy.getRetryDelay(2) == 10000);
+	CHECK(policy.getRetryDelay(3) == 20000);
+	CHECK(policy.getRetryDelay(4) == 40000);
+	CHECK(policy.getRetryDelay(5) == 60000);
+	CHECK(policy.getRetryDelay(20) == 60000);
+
+	policy.setMaxRetries(1);
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_TRANSIENT, 1) == InstallErrorPolicy::ACTION_RETRY);
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_TRANSIENT, 2) == InstallErrorPolicy::ACTION_SKIP);
+}
+
+static void testSkips()
+{
+	InstallErrorPolicy policy;
+
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_NONE, 1) == InstallErrorPolicy::ACTION_CONTINUE);
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_CONTENT, 1) == InstallErrorPolicy::ACTION_SKIP);
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_SPACE, 1) == InstallErrorPolicy::ACTION_SKIP);
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_PERMISSION, 1) == InstallErrorPolicy::ACTION_SKIP);
+	CHECK(policy.decide(-1, 1) == InstallErrorPolicy::ACTION_SKIP);
+
+	//! only transient errors are retried, whatever the action says
+	policy.setAction(InstallErrorPolicy::ERROR_CLASS_SPACE, InstallErrorPolicy::ACTION_RETRY);
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_SPACE, 1) == InstallErrorPolicy::ACTION_SKIP);
+
+	policy.setAction(InstallErrorPolicy::ERROR_CLASS_SPACE, InstallErrorPolicy::ACTION_ABORT);
+	CHECK(policy.decide(InstallErrorPolicy::ERROR_CLASS_SPACE, 1) == InstallErrorPolicy::ACTION_ABORT);
+}
+
+int main()
+{
+	testClassify();
+	testTransientRetries();
+	testSkips();
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "install/InstallJournal.h"
+#include "fs/fs_utils.h"
+
+#define TEST_JOURNAL_PATH    "InstallJournalTest.txt"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+//! the host version of the loader in fs_utils.c which needs the wut FS client
+extern "C" int LoadFileToMem(const char *filepath, u8 **inbuffer, u32 *size)
+{
+	FILE * file = fopen(filepath, "rb");
+	if(!file)
+		return -1;
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	u8 * buffer = (u8 *) malloc(length > 0 ? length : 1);
+	if(!buffer || fread(buffer, 1, length, file) != (size_t)length)
+	{
+		free(buffer);
+		fclose(file);
+		return -2;
+	}
+
+	fclose(file);
+	*inbuffer = buffer;
+	*size = length;
+	return length;
+}
+
+static void writeJournal(const char * content)
+{
+	FILE * file = fopen(TEST_JOURNAL_PATH, "wb");
+	fwrite(content, 1, strlen(content), file);
+	fclose(file);
+}
+
+static bool loadJournal(const char * content, std::vector<std::string> & pending)
+{
+	writeJournal(content);
+	return InstallJournal(TEST_JOURNAL_PATH).load(pending);
+}
+
+static void testMissingEnd()
+{
+	std::vector<std::string> pending;
+
+	CHECK(loadJournal("B 4\nQ 0 /a\nQ 1 /b\nQ 2 /c\nQ 3 /d\nS 0\nC 0\nS 1\nF 1 -5\nS 2\n", pending));
+	//! the started title is installed again, the failed one is not
+	CHECK(pending.size() == 2);
+	CHECK(pending.size() == 2 && pending[0] == "/c" && pending[1] == "/d");
+}
+
+static void testEnded()
+{
+	std::vector<std::string> pending;
+
+	CHECK(!loadJournal("B 2\nQ 0 /a\nQ 1 /b\nS 0\nC 0\nE\n", pending));
+	CHECK(pending.empty());
+	CHECK(!loadJournal("B 2\nQ 0 /a\nQ 1 /b\nS 0\nC 0\nS 1\nC 1\n", pending));
+}
+
+static void testTornLastLine()
+{
+	std::vector<std::string> pending;
+
+	//! the completion of /b did not make it to the card
+	CHECK(loadJournal("B 2\nQ 0 /a\nQ 1 /b\nS 0\nC 0\nS 1\nC", pending));
+	CHECK(pending.size() == 1 && pending[0] == "/b");
+
+	//! a torn end line does not end the batch
+	CHECK(loadJournal("B 2\nQ 0 /a\nQ 1 /b\nS 0\nC 0\nE", pending));
+	CHECK(pending.size() == 1 && pending[0] == "/b");
+
+	//! a torn path is not used
+	CHECK(!loadJournal("B 2\nQ 0 /a\nQ 1 /b/pa", pending));
+	CHECK(pending.empty());
+}
+
+static void testPartialQueue()
+{
+	std::vector<std::string> pending;
+
+	CHECK(!loadJournal("B 3\nQ 0 /a\nQ 1 /b\n", pending));
+	CHECK(!loadJournal("B 3\n", pending));
+	//! a position out of order does not count as queued
+	CHECK(!loadJournal("B 2\nQ 0 /a\nQ 2 /b\n", pending));
+	CHECK(!loadJournal("B 2\nQ 0 /a\nQ 1\n", pending));
+	CHECK(pending.empty());
+}
+
+static void testNewBatch()
+{
+	std::vector<std::string> pending;
+
+	//! only the last batch of the file counts
+	CHECK(loadJournal("B 1\nQ 0 /old\nB 2\nQ 0 /a\nQ 1 /b\nS 0\nC 0\n", pending));
+	CHECK(pending.size() == 1 && pending[0] == "/b");
+}
+
+static void testNoJournal()
+{
+	std::vector<std::string> pending;
+
+	unlink(TEST_JOURNAL_PATH);
+	CHECK(!InstallJournal(TEST_JOURNAL_PATH).load(pending));
+	CHECK(!loadJournal("", pending));
+}
+
+static void testRoundTrip()
+{
+	std::vector<std::string> paths;
+	paths.push_back("/install/game");
+	paths.push_back("/install/game update");
+	paths.push_back("/install/dlc");
+
+	InstallJournal journal(TEST_JOURNAL_PATH);
+	CHECK(journal.begin(paths));
+	journal.started(0);
+	journal.completed(0);
+	journal.started(1);
+
+	std::vector<std::string> pending;
+	CHECK(InstallJournal(TEST_JOURNAL_PATH).load(pending));
+	CHECK(pending.size() == 2 && pending[0] == "/install/game update" && pending[1] == "/install/dlc");
+
+	journal.failed(1, -3);
+	journal.started(2);
+	journal.completed(2);
+	journal.end();
+	CHECK(!InstallJournal(TEST_JOURNAL_PATH).load(pending));
+
+	journal.discard();
+	CHECK(access(TEST_JOURNAL_PATH, F_OK) != 0);
+}
+
+static u32 fileSize(const char * path)
+{
+	struct stat st;
+	return (stat(path, &st) == 0) ? st.st_size : 0;
+}
+
+static bool contains(const std::vector<std::string> & list, const std::string & value)
+{
+	for(u32 i = 0; i < list.size(); i++)
+	{
+		if(list[i] == value)
+			return true;
+	}
+	return false;
+}
+
+//! a power loss can cut the journal after any byte
+static void testTruncatedEverywhere()
+{
+	std::vector<std::string> paths;
+	paths.push_back("/install/game");
+	paths.push_back("/install/broken");
+	paths.push_back("/install/game update");
+	paths.push_back("/install/started");
+	paths.push_back("/install/dlc");
+
+	//! file size once the title is completed or failed, titles 3 and 4 never are
+	u32 doneAt[5] = { (u32) -1, (u32) -1, (u32) -1, (u32) -1, (u32) -1 };
+
+	InstallJournal journal(TEST_JOURNAL_PATH);
+	CHECK(journal.begin(paths));
+	u32 queuedAt = fileSize(TEST_JOURNAL_PATH);
+	journal.started(0);
+	journal.completed(0);
+	doneAt[0] = fileSize(TEST_JOURNAL_PATH);
+	journal.started(1);
+	journal.failed(1, -9);
+	doneAt[1] = fileSize(TEST_JOURNAL_PATH);
+	journal.started(2);
+	journal.completed(2);
+	doneAt[2] = fileSize(TEST_JOURNAL_PATH);
+	journal.started(3);
+
+	u8 * data = NULL;
+	u32 size = 0;
+	CHECK(LoadFileToMem(TEST_JOURNAL_PATH, &data, &size) > 0);
+
+	for(u32 length = 0; length <= size; length++)
+	{
+		FILE * file = fopen(TEST_JOURNAL_PATH, "wb");
+		fwrite(data, 1, length, file);
+		fclose(file);
+
+		std::vector<std::string> pending;
+		bool resume = InstallJournal(TEST_JOURNAL_PATH).load(pending);
+
+		//! nothing to resume until the whole queue is on the card
+		CHECK(resume == (length >= queuedAt));
+		if(!resume)
+		{
+			CHECK(pending.empty());
+			continue;
+		}
+
+		for(u32 i = 0; i < paths.size(); i++)
+		{
+			//! a completed title is never installed again, an unfinished one never dropped
+			bool done = (length >= doneAt[i]);
+			if(done == contains(pending, paths[i]))
+			{
+				printf("truncated at %u: %s\n", length, paths[i].c_str());
+				failures++;
+			}
+		}
+	}
+
+	free(data);
+	journal.discard();
+}
+
+int main()
+{
+	testMissingEnd();
+	testEnded();
+	testTornLastLine();
+	testPartialQueue();
+	testNewBatch();
+	testNoJournal();
+	testRoundTrip();
+	testTruncatedEverywhere();
+
+	unlink(TEST_JOURNAL_PATH);
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <vector>
+#include "install/InstallScheduler.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+#define TYPE_GAME      0x00050000
+#define TYPE_UPDATE    0x0005000E
+#define TYPE_DLC       0x0005000C
+
+static std::vector<InstallScheduler::Entry> entries;
+
+static void add(int index, u32 high, u32 low, u64 size)
+{
+	InstallScheduler::Entry entry;
+	entry.index = index;
+	entry.titleIdHigh = high;
+	entry.titleIdLow = low;
+	entry.size = size;
+	entries.push_back(entry);
+}
+
+static bool equals(const std::vector<int> & order, const int * expected, u32 count)
+{
+	if(order.size() != count)
+		return false;
+
+	for(u32 i = 0; i < count; i++)
+	{
+		if(order[i] != expected[i])
+			return false;
+	}
+	return true;
+}
+
+//! clicked in the worst order: DLC and update of a game before the game itself
+static void setupBatch()
+{
+	entries.clear();
+	add(10, TYPE_DLC,    0x10100, 300);
+	add(11, TYPE_UPDATE, 0x10100, 200);
+	add(20, TYPE_GAME,   0x20200, 50);
+	add(12, TYPE_GAME,   0x10100, 1000);
+	add(30, TYPE_UPDATE, 0x30300, 5000);
+}
+
+static void testGrouping()
+{
+	setupBatch();
+
+	//! every game goes before its update and its DLC, the groups keep the click order
+	const int expected[] = { 12, 11, 10, 20, 30 };
+	std::vector<int> order = InstallScheduler::order(entries, InstallScheduler::POLICY_CLICK_ORDER);
+	CHECK(equals(order, expected, 5));
+}
+
+static void testPolicies()
+{
+	setupBatch();
+
+	const int smallest[] = { 20, 12, 11, 10, 30 };
+	CHECK(equals(InstallScheduler::order(entries, InstallScheduler::POLICY_SMALLEST_FIRST), smallest, 5));
+
+	const int largest[] = { 30, 12, 11, 10, 20 };
+	CHECK(equals(InstallScheduler::order(entries, InstallScheduler::POLICY_LARGEST_FIRST), largest, 5));
+}
+
+static void testWithoutTitleId()
+{
+	entries.clear();
+	add(0, 0, 0, 10);
+	add(1, TYPE_UPDATE, 0x40400, 10);
+	add(2, 0, 0, 10);
+	add(3, 0x00050002, 0x40400, 10);
+	add(4, TYPE_GAME, 0x40400, 10);
+
+	//! folders without a title id are groups of their own, unknown types go last in a group
+	const int expected[] = { 0, 4, 1, 3, 2 };
+	CHECK(equals(InstallScheduler::order(entries, InstallScheduler::POLICY_CLICK_ORDER), expected, 5));
+
+	CHECK(InstallScheduler::getTypeRank(TYPE_GAME) < InstallScheduler::getTypeRank(TYPE_UPDATE));
+	CHECK(InstallScheduler::getTypeRank(TYPE_UPDATE) < InstallScheduler::getTypeRank(TYPE_DLC));
+	CHECK(InstallScheduler::getTypeRank(TYPE_DLC) < InstallScheduler::getTypeRank(0x00050002));
+
+	entries.clear();
+	CHECK(InstallScheduler::order(entries, InstallScheduler::POLICY_CLICK_ORDER).empty());
+}
+
+int main()
+{
+	testGrouping();
+	testPolicies();
+	testWithoutTitleId();
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
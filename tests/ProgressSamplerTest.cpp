@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <math.h>
+#include "install/ProgressSampler.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+#define MIB    (1024ULL * 1024ULL)
+
+//! an install that moves exactly as far as the test says
+class FakeProgress : public ProgressSource
+{
+public:
+	FakeProgress(u64 total) : installed(0), totalSize(total), available(true) {}
+
+	bool getProgress(u64 & installedSize, u64 & total)
+	{
+		installedSize = installed;
+		total = totalSize;
+		return available;
+	}
+
+	u64 installed;
+	u64 totalSize;
+	bool available;
+};
+
+//! runs the sampler for durationMs at bytesPerSecond, one sample every stepMs
+static void run(ProgressSampler & sampler, FakeProgress & source, u64 & nowMs, u64 durationMs, u64 bytesPerSecond, u32 stepMs)
+{
+	for(u64 end = nowMs + durationMs; nowMs < end; )
+	{
+		nowMs += stepMs;
+		source.installed += bytesPerSecond * stepMs / 1000;
+		if(source.installed > source.totalSize)
+			source.installed = source.totalSize;
+		sampler.sample(nowMs);
+	}
+}
+
+static void testNoProgress()
+{
+	FakeProgress source(100 * MIB);
+	ProgressSampler sampler(&source);
+
+	source.available = false;
+	CHECK(sampler.sample(1000) == ProgressSampler::UNCHANGED);
+	CHECK(sampler.getPercent() == -1);
+	CHECK(sampler.getInterval() == 100);
+}
+
+static void testThroughput()
+{
+	FakeProgress source(20000 * MIB);
+	ProgressSampler sampler(&source);
+	u64 nowMs = 1000;
+
+	sampler.sample(nowMs);
+	run(sampler, source, nowMs, 10000, 30 * MIB, 100);
+	CHECK(fabsf(sampler.getThroughput() - 30.0f) < 0.3f);
+
+	//! the average follows a drop within a few time constants
+	run(sampler, source, nowMs, 2000, 10 * MIB, 100);
+	CHECK(sampler.getThroughput() > 12.0f && sampler.getThroughput() < 25.0f);
+	run(sampler, source, nowMs, 10000, 10 * MIB, 100);
+	CHECK(fabsf(sampler.getThroughput() - 10.0f) < 0.3f);
+
+	CHECK(fabsf(sampler.getPeakThroughput() - 30.0f) < 0.3f);
+	CHECK(fabsf(sampler.getAverageThroughput() - (30.0f * 10 + 10.0f * 12) / 22) < 0.5f);
+
+	//! time left is what is left at the current speed
+	f32 left = (source.totalSize - source.installed) / (f32) MIB / sampler.getThroughput();
+	CHECK(fabsf(sampler.getEta() - left) <= 1.0f);
+	CHECK(sampler.getEta() > 1900 && sampler.getEta() < 2000);
+
+	//! every sample was 10 or 30 MiB/s
+	const u32 * histogram = sampler.getHistogram();
+	u32 samples = 0;
+	for(int i = 0; i < ProgressSampler::HistogramBuckets; i++)
+		samples += histogram[i];
+	CHECK(samples == 220);
+	CHECK(histogram[30] == 100 && histogram[10] == 120);
+}
+
+static void testInterval()
+{
+	u64 nowMs = 1000;
+
+	//! a big title at low speed would poll far too rarely
+	FakeProgress slow(20000 * MIB);
+	ProgressSampler slowSampler(&slow);
+	slowSampler.sample(nowMs);
+	run(slowSampler, slow, nowMs, 3000, 1 * MIB, 100);
+	CHECK(slowSampler.getInterval() == ProgressSampler::MaxInterval);
+
+	//! a small title at high speed would poll far too often
+	FakeProgress fast(50 * MIB);
+	ProgressSampler fastSampler(&fast);
+	fastSampler.sample(nowMs);
+	run(fastSampler, fast, nowMs, 500, 40 * MIB, 10);
+	CHECK(fastSampler.getInterval() == ProgressSampler::MinInterval);
+
+	//! in between it polls about every half percent
+	FakeProgress normal(2000 * MIB);
+	ProgressSampler normalSampler(&normal);
+	normalSampler.sample(nowMs);
+	run(normalSampler, normal, nowMs, 10000, 80 * MIB, 100);
+	CHECK(normalSampler.getInterval() >= 120 && normalSampler.getInterval() <= 130);
+}
+
+static void testInfoRefresh()
+{
+	FakeProgress source(100000 * MIB);
+	ProgressSampler sampler(&source);
+	u64 nowMs = 1000;
+
+	CHECK(sampler.sample(nowMs) & ProgressSampler::INFO_CHANGED);
+	CHECK(sampler.getInfo() == "0.0 / 100000.0 MiB (0%)");
+
+	//! 10 s of 50 ms samples, the percent does not change
+	int changes = 0;
+	u64 lastChange = nowMs;
+	bool tooEarly = false;
+
+	for(int i = 0; i < 200; i++)
+	{
+		nowMs += 50;
+		source.installed += 30 * MIB / 20;
+
+		int result = sampler.sample(nowMs);
+		CHECK(!(result & ProgressSampler::PERCENT_CHANGED));
+
+		if(result & ProgressSampler::INFO_CHANGED)
+		{
+			if(nowMs - lastChange < ProgressSampler::InfoInterval)
+				tooEarly = true;
+			lastChange = nowMs;
+			changes++;
+		}
+	}
+
+	CHECK(!tooEarly);
+	CHECK(changes == 10);
+	CHECK(sampler.getInfo().find("30.0 MiB/s") != std::string::npos);
+
+	//! a percent step shows up with the next sample
+	source.installed = 1000 * MIB;
+	nowMs += 50;
+	int result = sampler.sample(nowMs);
+	CHECK(result & ProgressSampler::PERCENT_CHANGED);
+	CHECK(result & ProgressSampler::INFO_CHANGED);
+	CHECK(sampler.getInfo().find("(1%)") != std::string::npos);
+}
+
+int main()
+{
+	testNoProgress();
+	testThroughput();
+	testInterval();
+	testInfoRefresh();
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <vector>
+#include "install/SpacePlanner.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+#define GB             (1024ULL * 1024ULL * 1024ULL)
+
+static u64 total(const std::vector<u64> & sizes, const std::vector<int> & chosen)
+{
+	u64 sum = 0;
+	for(u32 i = 0; i < chosen.size(); i++)
+		sum += sizes[chosen[i]];
+	return sum;
+}
+
+static void testExactFit()
+{
+	std::vector<u64> sizes;
+	sizes.push_back(4000);
+	sizes.push_back(6000);
+	sizes.push_back(10000);
+
+	//! the whole batch fits exactly, both policies take everything
+	std::vector<int> chosen = SpacePlanner::select(sizes, 20000, SpacePlanner::POLICY_MOST_BYTES);
+	CHECK(chosen.size() == 3);
+	CHECK(total(sizes, chosen) == 20000);
+
+	chosen = SpacePlanner::select(sizes, 20000, SpacePlanner::POLICY_MOST_TITLES);
+	CHECK(chosen.size() == 3);
+
+	//! one byte less and the knapsack finds the pair that fills it up
+	chosen = SpacePlanner::select(sizes, 16000, SpacePlanner::POLICY_MOST_BYTES);
+	CHECK(chosen.size() == 2 && chosen[0] == 1 && chosen[1] == 2);
+	CHECK(total(sizes, chosen) == 16000);
+}
+
+static void testKnapsackBeatsGreedy()
+{
+	std::vector<u64> sizes;
+	sizes.push_back(3);
+	sizes.push_back(5);
+	sizes.push_back(7);
+
+	//! smallest first stops at 3 + 5, the knapsack uses all of the space with 5 + 7
+	std::vector<int> greedy = SpacePlanner::select(sizes, 12, SpacePlanner::POLICY_MOST_TITLES);
+	CHECK(greedy.size() == 2 && greedy[0] == 0 && greedy[1] == 1);
+	CHECK(total(sizes, greedy) == 8);
+
+	std::vector<int> knapsack = SpacePlanner::select(sizes, 12, SpacePlanner::POLICY_MOST_BYTES);
+	CHECK(knapsack.size() == 2 && knapsack[0] == 1 && knapsack[1] == 2);
+	CHECK(total(sizes, knapsack) == 12);
+}
+
+static void testLargeCapacity()
+{
+	//! 32 GB are far more than 65536 units of one byte, sizes get rounded
+	u64 capacity = 32 * GB;
+	std::vector<u64> sizes;
+	sizes.push_back(20 * GB + 12345);
+	sizes.push_back(15 * GB + 1);
+	sizes.push_back(11 * GB + 777);
+	sizes.push_back(9 * GB);
+	sizes.push_back(40 * GB);
+
+	//! 20 + 11 is the best fit, smallest first stops at 9 + 11
+	std::vector<int> chosen = SpacePlanner::select(sizes, capacity, SpacePlanner::POLICY_MOST_BYTES);
+	CHECK(chosen.size() == 2 && chosen[0] == 0 && chosen[1] == 2);
+	CHECK(total(sizes, chosen) <= capacity);
+
+	std::vector<int> greedy = SpacePlanner::select(sizes, capacity, SpacePlanner::POLICY_MOST_TITLES);
+	CHECK(total(sizes, greedy) <= capacity);
+	CHECK(total(sizes, greedy) < total(sizes, chosen));
+
+	//! rounding never lets a batch that is a byte too large through
+	sizes.clear();
+	sizes.push_back(capacity / 2);
+	sizes.push_back(capacity / 2 + 1);
+	chosen = SpacePlanner::select(sizes, capacity, SpacePlanner::POLICY_MOST_BYTES);
+	CHECK(chosen.size() == 1);
+	CHECK(total(sizes, chosen) <= capacity);
+}
+
+static void testUnknownSize()
+{
+	std::vector<u64> sizes;
+	sizes.push_back(0);
+	sizes.push_back(100);
+	sizes.push_back(0);
+
+	//! titles without a size cost nothing and are kept
+	std::vector<int> chosen = SpacePlanner::select(sizes, 50, SpacePlanner::POLICY_MOST_BYTES);
+	CHECK(chosen.size() == 2 && chosen[0] == 0 && chosen[1] == 2);
+}
+
+int main()
+{
+	testExactFit();
+	testKnapsackBeatsGreedy();
+	testLargeCapacity();
+	testUnknownSize();
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
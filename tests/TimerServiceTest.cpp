@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <time.h>
+#include "system/TimerService.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+//! a thread that spins for the whole wait would use about as much cpu time as wall time
+#define MAX_CPU_MS     50
+
+//! cpu time of every thread of the process, the timer thread included
+static u64 cpuTimeMs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (u64)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+static u64 wallTimeMs()
+{
+	return OSTicksToMilliseconds(OSGetTime());
+}
+
+static void testSleepIdles()
+{
+	CEvent event;
+
+	u64 cpuStart = cpuTimeMs();
+	u64 wallStart = wallTimeMs();
+
+	bool elapsed = TimerService::instance()->sleep(500, &event);
+
+	u64 wall = wallTimeMs() - wallStart;
+	u64 cpu = cpuTimeMs() - cpuStart;
+
+	CHECK(elapsed);
+	CHECK(wall >= 500 && wall < 1000);
+	CHECK(cpu < MAX_CPU_MS);
+}
+
+static void testWakeUpEarly()
+{
+	CEvent event;
+	TimerGuard wakeUp(TimerService::instance()->addTimer(100, 0, [&event]() {
+		event.signal();
+	}));
+
+	u64 wallStart = wallTimeMs();
+	bool elapsed = TimerService::instance()->sleep(5000, &event);
+	u64 wall = wallTimeMs() - wallStart;
+
+	CHECK(!elapsed);
+	CHECK(wall >= 100 && wall < 1000);
+}
+
+//! the countdown between two titles: a ticking timer and a sleep until the end
+static void testCountdownIdles()
+{
+	CEvent event;
+	volatile int time = 5;
+
+	u64 cpuStart = cpuTimeMs();
+	u64 now = OSGetTime();
+	u64 endTime = now + OSMillisecondsToTicks(time * 100);
+
+	{
+		TimerGuard countdown(TimerService::instance()->addTimer(100, 100, [&time]() {
+			if(time > 0)
+				time--;
+		}));
+
+		while(now < endTime)
+		{
+			TimerService::instance()->sleep(OSTicksToMilliseconds(endTime - now), &event);
+			now = OSGetTime();
+		}
+	}
+
+	u64 cpu = cpuTimeMs() - cpuStart;
+
+	//! the last tick and the end of the sleep are due at the same time
+	CHECK(time <= 1);
+	CHECK(cpu < MAX_CPU_MS);
+}
+
+int main()
+{
+	testSleepIdles();
+	testWakeUpEarly();
+	testCountdownIdles();
+
+	TimerService::destroyInstance();
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
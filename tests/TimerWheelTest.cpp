@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <vector>
+#include "system/TimerWheel.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+//! only moves when the test says so
+class ManualClock : public TimerClock
+{
+public:
+	ManualClock(u64 start = 1000) : now(start) {}
+
+	u64 getTimeMs() const { return now; }
+	void advance(u64 ms) { now += ms; }
+
+private:
+	u64 now;
+};
+
+static std::vector<int> results;
+
+static TimerWheel::Callback push(int value)
+{
+	return [value]() { results.push_back(value); };
+}
+
+//! runs what the wheel collected and returns the values the timers pushed
+static std::vector<int> fire(TimerWheel & wheel)
+{
+	std::vector<TimerWheel::Callback> fired;
+	wheel.advance(fired);
+
+	for(u32 i = 0; i < fired.size(); i++)
+		fired[i]();
+
+	std::vector<int> order;
+	order.swap(results);
+	return order;
+}
+
+static void testExpiryOrder()
+{
+	ManualClock clock;
+	TimerWheel wheel(clock, 10, 8);
+
+	wheel.add(50, 0, push(3));
+	wheel.add(20, 0, push(1));
+	//! one wheel turn later, lands in the same slot as the 20 ms timer
+	wheel.add(100, 0, push(5));
+	wheel.add(20, 0, push(2));
+	wheel.add(70, 0, push(4));
+
+	CHECK(wheel.count() == 5);
+	CHECK(wheel.timeUntilNext() == 20);
+
+	clock.advance(19);
+	CHECK(fire(wheel).empty());
+
+	clock.advance(1);
+	std::vector<int> order = fire(wheel);
+	CHECK(order.size() == 2 && order[0] == 1 && order[1] == 2);
+	CHECK(wheel.timeUntilNext() == 30);
+
+	//! a sleep over more than one turn still fires everything in order
+	clock.advance(500);
+	order = fire(wheel);
+	CHECK(order.size() == 3 && order[0] == 3 && order[1] == 4 && order[2] == 5);
+	CHECK(wheel.empty());
+	CHECK(wheel.timeUntilNext() == (u32) -1);
+}
+
+static void testRepeat()
+{
+	ManualClock clock;
+	TimerWheel wheel(clock);
+
+	wheel.add(100, 30, push(1));
+
+	clock.advance(100);
+	CHECK(fire(wheel).size() == 1);
+	CHECK(wheel.count() == 1);
+	CHECK(wheel.timeUntilNext() == 30);
+
+	clock.advance(30);
+	CHECK(fire(wheel).size() == 1);
+
+	//! missed periods are not caught up, the next one is a period from now
+	clock.advance(100);
+	CHECK(fire(wheel).size() == 1);
+	CHECK(wheel.timeUntilNext() == 30);
+
+	clock.advance(29);
+	CHECK(fire(wheel).empty());
+	clock.advance(1);
+	CHECK(fire(wheel).size() == 1);
+}
+
+static void testCancel()
+{
+	ManualClock clock;
+	TimerWheel wheel(clock);
+
+	u32 first = wheel.add(10, 0, push(1));
+	u32 second = wheel.add(10, 0, push(2));
+	u32 periodic = wheel.add(10, 10, push(3));
+
+	CHECK(first != 0 && second != 0 && periodic != 0);
+	CHECK(first != second && second != periodic);
+
+	CHECK(wheel.remove(first));
+	CHECK(!wheel.remove(first));
+	CHECK(!wheel.remove(12345));
+
+	clock.advance(10);
+	std::vector<int> order = fire(wheel);
+	CHECK(order.size() == 2 && order[0] == 2 && order[1] == 3);
+
+	//! a one-shot timer that fired is gone, a periodic one is still there
+	CHECK(!wheel.remove(second));
+	CHECK(wheel.remove(periodic));
+	CHECK(wheel.empty());
+
+	clock.advance(100);
+	CHECK(fire(wheel).empty());
+}
+
+static void testNextExpiry()
+{
+	ManualClock clock;
+	TimerWheel wheel(clock, 10, 8);
+
+	u32 first = wheel.add(30, 0, push(1));
+	u32 second = wheel.add(50, 0, push(2));
+	//! lands in the slot of the 30 ms timer one turn later
+	u32 third = wheel.add(110, 0, push(3));
+	CHECK(wheel.timeUntilNext() == 30);
+
+	//! an earlier timer moves the next expiry forward right away
+	u32 early = wheel.add(5, 0, push(4));
+	CHECK(wheel.timeUntilNext() == 5);
+
+	//! removing the earliest one falls back to the next in line
+	CHECK(wheel.remove(early));
+	CHECK(wheel.timeUntilNext() == 30);
+	CHECK(wheel.remove(first));
+	CHECK(wheel.timeUntilNext() == 50);
+
+	//! removing a later one leaves the next expiry alone
+	CHECK(wheel.remove(third));
+	CHECK(!wheel.remove(third));
+	CHECK(wheel.timeUntilNext() == 50);
+
+	clock.advance(50);
+	CHECK(fire(wheel).size() == 1);
+	CHECK(!wheel.remove(second));
+	CHECK(wheel.timeUntilNext() == (u32) -1);
+}
+
+int main()
+{
+	testExpiryOrder();
+	testRepeat();
+	testCancel();
+	testNextExpiry();
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
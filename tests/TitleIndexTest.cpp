@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include "install/TitleIndex.h"
+#include "install/InstallBackend.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+#define GAME_ID        0x0005000010101000ULL
+#define UPDATE_ID      0x0005000E10101000ULL
+
+static void testVersion()
+{
+	FakeTitleIndex index;
+	index.add(GAME_ID, 32, InstallBackend::NAND);
+
+	//! same or older version is installed, newer is not
+	CHECK(index.isInstalled(GAME_ID, 32, InstallBackend::NAND));
+	CHECK(index.isInstalled(GAME_ID, 16, InstallBackend::NAND));
+	CHECK(!index.isInstalled(GAME_ID, 48, InstallBackend::NAND));
+
+	//! the title ID has to match exactly
+	CHECK(!index.isInstalled(UPDATE_ID, 0, InstallBackend::NAND));
+
+	//! an older version never replaces a newer one
+	index.add(GAME_ID, 0, InstallBackend::NAND);
+	CHECK(index.isInstalled(GAME_ID, 32, InstallBackend::NAND));
+	index.add(GAME_ID, 48, InstallBackend::NAND);
+	CHECK(index.isInstalled(GAME_ID, 48, InstallBackend::NAND));
+	CHECK(index.getCount(InstallBackend::NAND) == 1);
+}
+
+static void testTargets()
+{
+	FakeTitleIndex index;
+	index.add(GAME_ID, 32, InstallBackend::NAND);
+	index.add(UPDATE_ID, 80, InstallBackend::USB);
+
+	//! mlc and usb are looked up separately
+	CHECK(index.isInstalled(GAME_ID, 32, InstallBackend::NAND));
+	CHECK(!index.isInstalled(GAME_ID, 32, InstallBackend::USB));
+	CHECK(index.isInstalled(UPDATE_ID, 80, InstallBackend::USB));
+	CHECK(!index.isInstalled(UPDATE_ID, 80, InstallBackend::NAND));
+	CHECK(index.getCount(InstallBackend::NAND) == 1);
+	CHECK(index.getCount(InstallBackend::USB) == 1);
+
+	//! unknown targets have nothing installed and take nothing
+	index.add(GAME_ID, 32, 2);
+	CHECK(!index.isInstalled(GAME_ID, 32, 2));
+	CHECK(!index.isInstalled(GAME_ID, 32, -1));
+	CHECK(index.getCount(2) == 0);
+}
+
+static void testSimulatedInstance()
+{
+	//! the simulated build starts with an empty index and keeps what was installed
+	TitleIndex * index = TitleIndex::instance();
+	CHECK(index->getCount(InstallBackend::NAND) == 0);
+	CHECK(index->getCount(InstallBackend::USB) == 0);
+
+	index->add(GAME_ID, 32, InstallBackend::USB);
+	CHECK(TitleIndex::instance()->isInstalled(GAME_ID, 32, InstallBackend::USB));
+
+	TitleIndex::destroyInstance();
+	CHECK(!TitleIndex::instance()->isInstalled(GAME_ID, 32, InstallBackend::USB));
+	TitleIndex::destroyInstance();
+}
+
+int main()
+{
+	testVersion();
+	testTargets();
+	testSimulatedInstance();
+
+	if(failures)
+		printf("%d checks failed\n", failures);
+
+	return failures ? 1 : 0;
+}
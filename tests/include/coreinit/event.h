@@ -0,0 +1,88 @@
+#ifndef _HOST_COREINIT_EVENT_H_
+#define _HOST_COREINIT_EVENT_H_
+
+//! Host stand-in for the wut header, waits on a monotonic clock
+#include <pthread.h>
+#include <time.h>
+#include <coreinit/thread.h>
+
+typedef enum OSEventMode
+{
+	OS_EVENT_MODE_MANUAL = 0,
+	OS_EVENT_MODE_AUTO = 1
+} OSEventMode;
+
+typedef struct OSEvent
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	BOOL value;
+	OSEventMode mode;
+} OSEvent;
+
+static inline void OSInitEvent(OSEvent *event, BOOL value, OSEventMode mode)
+{
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&event->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_mutex_init(&event->mutex, NULL);
+	event->value = value;
+	event->mode = mode;
+}
+
+static inline void OSSignalEvent(OSEvent *event)
+{
+	pthread_mutex_lock(&event->mutex);
+	event->value = TRUE;
+	if(event->mode == OS_EVENT_MODE_AUTO)
+		pthread_cond_signal(&event->cond);
+	else
+		pthread_cond_broadcast(&event->cond);
+	pthread_mutex_unlock(&event->mutex);
+}
+
+static inline void OSResetEvent(OSEvent *event)
+{
+	pthread_mutex_lock(&event->mutex);
+	event->value = FALSE;
+	pthread_mutex_unlock(&event->mutex);
+}
+
+static inline void OSWaitEvent(OSEvent *event)
+{
+	pthread_mutex_lock(&event->mutex);
+	while(!event->value)
+		pthread_cond_wait(&event->cond, &event->mutex);
+	if(event->mode == OS_EVENT_MODE_AUTO)
+		event->value = FALSE;
+	pthread_mutex_unlock(&event->mutex);
+}
+
+static inline BOOL OSWaitEventWithTimeout(OSEvent *event, OSTime timeout)
+{
+	OSTime end = OSGetTime() + timeout;
+	struct timespec ts;
+	ts.tv_sec = end / 1000000000LL;
+	ts.tv_nsec = end % 1000000000LL;
+
+	BOOL signaled = TRUE;
+
+	pthread_mutex_lock(&event->mutex);
+	while(!event->value)
+	{
+		if(pthread_cond_timedwait(&event->cond, &event->mutex, &ts) != 0)
+		{
+			signaled = event->value;
+			break;
+		}
+	}
+	if(signaled && event->mode == OS_EVENT_MODE_AUTO)
+		event->value = FALSE;
+	pthread_mutex_unlock(&event->mutex);
+
+	return signaled;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef _HOST_COREINIT_MUTEX_H_
+#define _HOST_COREINIT_MUTEX_H_
+
+//! Host stand-in for the wut header, recursive like the OS mutex
+#include <pthread.h>
+
+typedef struct OSMutex
+{
+	pthread_mutex_t mutex;
+} OSMutex;
+
+static inline void OSInitMutex(OSMutex *mutex)
+{
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&mutex->mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+static inline void OSLockMutex(OSMutex *mutex)
+{
+	pthread_mutex_lock(&mutex->mutex);
+}
+
+static inline void OSUnlockMutex(OSMutex *mutex)
+{
+	pthread_mutex_unlock(&mutex->mutex);
+}
+
+static inline int OSTryLockMutex(OSMutex *mutex)
+{
+	return pthread_mutex_trylock(&mutex->mutex) == 0;
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef _HOST_COREINIT_THREAD_H_
+#define _HOST_COREINIT_THREAD_H_
+
+//! Host stand-in for the wut header. A thread is started on the first
+//! resume, suspending a running thread and priorities are not supported.
+#include <pthread.h>
+#include <stdint.h>
+#include <coreinit/time.h>
+
+typedef int BOOL;
+#ifndef TRUE
+#define TRUE    1
+#define FALSE   0
+#endif
+
+typedef int (*OSThreadEntryPointFn)(int argc, const char **argv);
+
+typedef struct OSThread
+{
+	pthread_t thread;
+	OSThreadEntryPointFn entry;
+	int argc;
+	const char **argv;
+	volatile BOOL started;
+	volatile BOOL terminated;
+} OSThread;
+
+static inline void *OSHostThreadEntry(void *arg)
+{
+	OSThread *thread = (OSThread *) arg;
+	thread->entry(thread->argc, thread->argv);
+	thread->terminated = TRUE;
+	return NULL;
+}
+
+static inline BOOL OSCreateThread(OSThread *thread, OSThreadEntryPointFn entry, int argc, char *argv,
+                                  void *stack, uint32_t stackSize, int32_t priority, int attributes)
+{
+	thread->entry = entry;
+	thread->argc = argc;
+	thread->argv = (const char **) argv;
+	thread->started = FALSE;
+	thread->terminated = FALSE;
+	return TRUE;
+}
+
+static inline void OSResumeThread(OSThread *thread)
+{
+	if(thread->started)
+		return;
+
+	thread->started = TRUE;
+	pthread_create(&thread->thread, NULL, OSHostThreadEntry, thread);
+}
+
+static inline void OSSuspendThread(OSThread *thread) {}
+static inline void OSSetThreadPriority(OSThread *thread, int priority) {}
+
+static inline BOOL OSIsThreadSuspended(OSThread *thread)
+{
+	return !thread->started;
+}
+
+static inline BOOL OSIsThreadTerminated(OSThread *thread)
+{
+	return thread->terminated;
+}
+
+static inline BOOL OSJoinThread(OSThread *thread, int *result)
+{
+	if(!thread->started)
+		return FALSE;
+
+	pthread_join(thread->thread, NULL);
+	return TRUE;
+}
+
+#endif
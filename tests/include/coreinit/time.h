@@ -0,0 +1,23 @@
+#ifndef _HOST_COREINIT_TIME_H_
+#define _HOST_COREINIT_TIME_H_
+
+//! Host stand-in for the wut header, one tick is one nanosecond
+#include <stdint.h>
+#include <time.h>
+
+typedef int64_t OSTime;
+typedef int32_t OSTick;
+
+static inline OSTime OSGetTime(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (OSTime)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+#define OSTicksToMilliseconds(ticks)    ((ticks) / 1000000LL)
+#define OSTicksToMicroseconds(ticks)    ((ticks) / 1000LL)
+#define OSMillisecondsToTicks(ms)       ((OSTime)(ms) * 1000000LL)
+#define OSMicrosecondsToTicks(us)       ((OSTime)(us) * 1000LL)
+
+#endif